@@ -0,0 +1,127 @@
+#include "book_builder.hpp"
+#include "game.hpp"
+#include "game_archive.hpp"
+#include "opening_book.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+void printUsage() {
+  std::cerr << "Usage: book_builder [options] -o <book"
+            << chess::kBookExtension
+            << "> <file or directory>...\n"
+               "Builds a Polyglot opening book from saved games (.dat), "
+               "game archives ("
+            << chess::kArchiveExtension
+            << ")\nand PGN files. Directories are searched recursively.\n\n"
+               "  -t <threads>   worker threads, 0 for one per hardware "
+               "thread\n"
+               "  -p <plies>     moves of each game to put in the book, 24 "
+               "by default\n"
+               "  -m <mb>        megabytes of records to sort in memory, "
+               "256 by default\n"
+               "  -T <dir>       directory for the sorted runs\n";
+}
+
+struct Arguments {
+  std::vector<std::filesystem::path> paths;
+  std::filesystem::path book;
+  chess::BookBuilderOptions options;
+};
+
+/// @return False if the command line is not understood.
+bool parseArguments(const int argc, char *argv[], Arguments &arguments) {
+  for (int i = 1; i < argc; i++) {
+    const std::string argument{argv[i]};
+    if (argument == "-t" && i + 1 < argc) {
+      arguments.options.sort.threads = std::stoi(argv[++i]);
+    } else if (argument == "-p" && i + 1 < argc) {
+      arguments.options.maxPly =
+          static_cast<std::uint32_t>(std::stoul(argv[++i]));
+    } else if (argument == "-m" && i + 1 < argc) {
+      arguments.options.sort.memory = std::stoul(argv[++i]) << 20;
+    } else if (argument == "-T" && i + 1 < argc) {
+      arguments.options.sort.tempDirectory = argv[++i];
+    } else if (argument == "-o" && i + 1 < argc) {
+      arguments.book = argv[++i];
+    } else if (!argument.empty() && argument[0] == '-') {
+      return false;
+    } else {
+      arguments.paths.emplace_back(argument);
+    }
+  }
+  return !arguments.paths.empty() && !arguments.book.empty() &&
+         arguments.options.sort.threads >= 0 &&
+         arguments.options.sort.memory > 0;
+}
+
+bool isGameFile(const std::filesystem::path &file) {
+  return file.extension() == ".dat" || file.extension() == ".pgn" ||
+         file.extension() == chess::kArchiveExtension;
+}
+
+/// @return The game files in @a paths, files in directories in name order.
+std::vector<std::filesystem::path>
+findGameFiles(const std::vector<std::filesystem::path> &paths) {
+  std::vector<std::filesystem::path> files;
+  for (const std::filesystem::path &path : paths) {
+    if (!std::filesystem::is_directory(path)) {
+      files.push_back(path);
+      continue;
+    }
+    std::vector<std::filesystem::path> found;
+    for (const auto &entry :
+         std::filesystem::recursive_directory_iterator{path}) {
+      if (entry.is_regular_file() && isGameFile(entry.path())) {
+        found.push_back(entry.path());
+      }
+    }
+    std::ranges::sort(found);
+    files.insert(files.end(), found.begin(), found.end());
+  }
+  return files;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Arguments arguments;
+  bool understood = false;
+  try {
+    understood = parseArguments(argc, argv, arguments);
+  } catch (const std::exception &) {
+    understood = false;
+  }
+  if (!understood) {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  try {
+    const chess::BookBuilderStats stats = chess::buildOpeningBook(
+        findGameFiles(arguments.paths), arguments.book, arguments.options);
+    const double seconds = stats.seconds;
+    std::cout << "Games: " << stats.games << '\n'
+              << "Failed: " << stats.failed << '\n'
+              << "Moves: " << stats.records << '\n'
+              << "Sorted runs: " << stats.runs << '\n'
+              << "Book entries: " << stats.entries << '\n'
+              << "Time: " << seconds << " s\n"
+              << "Games per second: "
+              << static_cast<std::uint64_t>(
+                     seconds > 0.0 ? stats.games / seconds : 0.0)
+              << '\n';
+  } catch (const chess::GameException &err) {
+    std::cerr << err.what() << '\n';
+    return EXIT_FAILURE;
+  } catch (const std::filesystem::filesystem_error &err) {
+    std::cerr << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,226 @@
+#include "game.hpp"
+#include "game_archive.hpp"
+#include "load_save.hpp"
+#include "thread_count.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+void printUsage() {
+  std::cerr << "Usage: chess_validate [options] <file or directory>...\n"
+               "Replays every saved game (.dat) and every game of each "
+               "archive ("
+            << chess::kArchiveExtension
+            << ")\nand reports the first illegal move of each, or the hash "
+               "of its final position.\nDirectories are searched "
+               "recursively.\n\n"
+               "  -t <threads>   worker threads, 0 for one per hardware "
+               "thread\n";
+}
+
+struct Arguments {
+  std::vector<std::filesystem::path> paths;
+  int threads = 0;
+};
+
+/// @return False if the command line is not understood.
+bool parseArguments(const int argc, char *argv[], Arguments &arguments) {
+  for (int i = 1; i < argc; i++) {
+    const std::string argument{argv[i]};
+    if (argument == "-t" && i + 1 < argc) {
+      arguments.threads = std::stoi(argv[++i]);
+    } else if (!argument.empty() && argument[0] == '-') {
+      return false;
+    } else {
+      arguments.paths.emplace_back(argument);
+    }
+  }
+  return !arguments.paths.empty() && arguments.threads >= 0;
+}
+
+/// A file to replay, with the archive kept open while its games are replayed
+struct Source {
+  std::filesystem::path file;
+  std::unique_ptr<chess::GameArchive> archive;
+  /// Why the file could not be opened, empty if it was
+  std::string error;
+};
+
+/// One game to replay: a text game, or one game of an archive
+struct Job {
+  std::size_t source = 0;
+  std::optional<std::size_t> game;
+};
+
+struct Result {
+  std::string error;
+  std::size_t plies = 0;
+  std::uint64_t hash = 0;
+};
+
+bool isGameFile(const std::filesystem::path &file) {
+  return file.extension() == ".dat" ||
+         file.extension() == chess::kArchiveExtension;
+}
+
+/// @return The game files in @a paths, files in directories in name order.
+std::vector<std::filesystem::path>
+findGameFiles(const std::vector<std::filesystem::path> &paths) {
+  std::vector<std::filesystem::path> files;
+  for (const std::filesystem::path &path : paths) {
+    if (!std::filesystem::is_directory(path)) {
+      files.push_back(path);
+      continue;
+    }
+    std::vector<std::filesystem::path> found;
+    for (const auto &entry :
+         std::filesystem::recursive_directory_iterator{path}) {
+      if (entry.is_regular_file() && isGameFile(entry.path())) {
+        found.push_back(entry.path());
+      }
+    }
+    std::ranges::sort(found);
+    files.insert(files.end(), found.begin(), found.end());
+  }
+  return files;
+}
+
+std::size_t countPlies(const chess::Game &game) {
+  std::size_t plies = 0;
+  for (const chess::Game::Round &round : game.rounds) {
+    plies += round.white_move.has_value() + round.black_move.has_value();
+  }
+  return plies;
+}
+
+Result replay(const Source &source, const Job &job) {
+  Result result;
+  chess::Game game;
+  if (!source.error.empty()) {
+    result.error = source.error;
+    return result;
+  }
+  if (job.game) {
+    try {
+      game = (*source.archive)[*job.game].replay();
+    } catch (const chess::GameException &err) {
+      result.error = err.what();
+      return result;
+    }
+  } else {
+    chess::LoadedGame loaded = chess::readGame(source.file);
+    if (!loaded.error.empty()) {
+      result.error = loaded.error;
+      return result;
+    }
+    game = std::move(loaded.game);
+  }
+  result.plies = countPlies(game);
+  result.hash = game.hash();
+  return result;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Arguments arguments;
+  bool understood = false;
+  try {
+    understood = parseArguments(argc, argv, arguments);
+  } catch (const std::exception &) {
+    understood = false;
+  }
+  if (!understood) {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Source> sources;
+  std::vector<Job> jobs;
+  try {
+    for (const std::filesystem::path &file : findGameFiles(arguments.paths)) {
+      Source &source = sources.emplace_back(Source{.file = file});
+      if (file.extension() != chess::kArchiveExtension) {
+        jobs.push_back({.source = sources.size() - 1});
+        continue;
+      }
+      try {
+        source.archive = std::make_unique<chess::GameArchive>(file);
+      } catch (const chess::GameException &err) {
+        source.error = err.what();
+        jobs.push_back({.source = sources.size() - 1});
+        continue;
+      }
+      for (std::size_t game = 0; game < source.archive->size(); game++) {
+        jobs.push_back({.source = sources.size() - 1, .game = game});
+      }
+    }
+  } catch (const std::filesystem::filesystem_error &err) {
+    std::cerr << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<Result> results(jobs.size());
+  std::atomic<std::size_t> next_job{0};
+  const auto worker = [&] {
+    for (std::size_t index = next_job++; index < jobs.size();
+         index = next_job++) {
+      results[index] = replay(sources[jobs[index].source], jobs[index]);
+    }
+  };
+  {
+    std::vector<std::jthread> pool;
+    const int threads = chess::threadCount(arguments.threads);
+    for (int thread = 1; thread < threads; thread++) {
+      pool.emplace_back(worker);
+    }
+    worker();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::size_t failed = 0;
+  std::size_t plies = 0;
+  for (std::size_t index = 0; index < jobs.size(); index++) {
+    const Job &job = jobs[index];
+    const Result &result = results[index];
+    std::cout << sources[job.source].file.string();
+    if (job.game) {
+      std::cout << '#' << *job.game + 1;
+    }
+    if (result.error.empty()) {
+      std::cout << ": " << result.plies << " plies, hash " << std::hex
+                << std::setw(16) << std::setfill('0') << result.hash
+                << std::dec << std::setfill(' ') << '\n';
+    } else {
+      std::cout << ": " << result.error << '\n';
+      failed++;
+    }
+    plies += result.plies;
+  }
+
+  const double seconds = elapsed.count();
+  const auto perSecond = [seconds](const std::size_t count) {
+    return seconds > 0.0 ? static_cast<std::uint64_t>(count / seconds) : 0;
+  };
+  std::cout << "Files: " << sources.size() << '\n'
+            << "Games: " << jobs.size() << '\n'
+            << "Failed: " << failed << '\n'
+            << "Plies: " << plies << '\n'
+            << "Time: " << seconds << " s\n"
+            << "Games per second: " << perSecond(jobs.size()) << '\n'
+            << "Plies per second: " << perSecond(plies) << '\n';
+  return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
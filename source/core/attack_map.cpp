@@ -0,0 +1,204 @@
+#include "attack_map.hpp"
+#include "attacks.hpp"
+
+#include <cassert>
+
+namespace chess {
+namespace {
+/// @return The squares @a piece on @a square attacks, empty for a king.
+Bitboard pieceAttacks(const PieceWithSide piece, const int square,
+                      const Bitboard occupied) {
+  switch (piece.mPiece) {
+  case Piece::kPawn:
+    return pawnAttacks(piece.mSide, square);
+  case Piece::kKnight:
+    return knightAttacks(square);
+  case Piece::kBishop:
+    return bishopAttacks(square, occupied);
+  case Piece::kRook:
+    return rookAttacks(square, occupied);
+  case Piece::kQueen:
+    return queenAttacks(square, occupied);
+  case Piece::kKing:
+    break;
+  }
+  return kEmptyBitboard;
+}
+} // namespace
+
+AttackMap::AttackMap(const Board &board) {
+  const Bitboard occupied = board.occupied();
+  for (const Side side : {Side::kWhite, Side::kBlack}) {
+    for (const Piece kind : {Piece::kPawn, Piece::kRook, Piece::kKnight,
+                             Piece::kBishop, Piece::kQueen}) {
+      const PieceWithSide piece{.mPiece = kind, .mSide = side};
+      for (const int square : board.pieceSquares(kind, side)) {
+        setAttacks(square, side, pieceAttacks(piece, square, occupied));
+      }
+    }
+  }
+}
+
+AttackMap::Delta AttackMap::update(const Board &board, const Bitboard changed) {
+  const Bitboard occupied = board.occupied();
+
+  // A slider's rays only change if one of them ended on, or now ends on, a
+  // changed square. In the second case the square was on the ray before too,
+  // so looking at the previous attacks is enough.
+  Bitboard stale = changed;
+  const Bitboard sliders = board.pieces(Piece::kBishop) |
+                           board.pieces(Piece::kRook) |
+                           board.pieces(Piece::kQueen);
+  for (const int square : BitboardSquares{sliders & ~changed}) {
+    if (mAttacksFrom[square] & changed) {
+      stale |= squareBit(square);
+    }
+  }
+
+  Delta delta;
+  for (const int square : BitboardSquares{stale}) {
+    assert(delta.size < Delta::kMaxChanges);
+    delta.changes[delta.size++] =
+        Change{.square = static_cast<std::int8_t>(square),
+               .side = mOwners[square],
+               .attacks = mAttacksFrom[square]};
+    if (const SquareState piece = board(squareToPosition(square))) {
+      setAttacks(square, piece->mSide, pieceAttacks(*piece, square, occupied));
+    } else {
+      setAttacks(square, Side::kWhite, kEmptyBitboard);
+    }
+  }
+  return delta;
+}
+
+void AttackMap::restore(const Delta &delta) {
+  for (int i = 0; i < delta.size; ++i) {
+    const Change &change = delta.changes[i];
+    setAttacks(change.square, change.side, change.attacks);
+  }
+}
+
+Bitboard AttackMap::attacked(const Side side) const {
+  return mAttacked[static_cast<int>(side)];
+}
+
+int AttackMap::attackerCount(const Position pos, const Side side) const {
+  return mAttackerCounts[static_cast<int>(side)][positionToSquare(pos)];
+}
+
+bool AttackMap::isAttacked(const Position pos, const Side side) const {
+  return (attacked(side) & positionBit(pos)) != 0;
+}
+
+Bitboard AttackMap::attacksFrom(const Position pos) const {
+  return mAttacksFrom[positionToSquare(pos)];
+}
+
+void AttackMap::setAttacks(const int square, const Side side,
+                           const Bitboard attacks) {
+  removeAttacks(mAttacksFrom[square], mOwners[square]);
+  addAttacks(attacks, side);
+  mAttacksFrom[square] = attacks;
+  // Keep empty entries identical, so that equal maps compare equal
+  mOwners[square] = attacks ? side : Side::kWhite;
+}
+
+void AttackMap::addAttacks(const Bitboard attacks, const Side side) {
+  mAttacked[static_cast<int>(side)] |= attacks;
+  for (const int square : BitboardSquares{attacks}) {
+    ++mAttackerCounts[static_cast<int>(side)][square];
+  }
+}
+
+void AttackMap::removeAttacks(const Bitboard attacks, const Side side) {
+  for (const int square : BitboardSquares{attacks}) {
+    if (--mAttackerCounts[static_cast<int>(side)][square] == 0) {
+      mAttacked[static_cast<int>(side)] &= ~squareBit(square);
+    }
+  }
+}
+
+} // namespace chess
+
+#if defined(UNIT_TEST)
+
+#include "board_positions.hpp"
+#include "logic.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("AttackMap initial board") {
+  const chess::Board board;
+  const chess::AttackMap attacks{board};
+
+  // The third row is covered by pawns and knights; kings do not count, so
+  // f2 is not attacked
+  CHECK(attacks.attacked(chess::Side::kWhite) == 0x0000000000FFDF56ULL);
+  CHECK(attacks.attackerCount(chess::Position{2, 0}, chess::Side::kWhite) ==
+        2);
+  CHECK(attacks.attackerCount(chess::Position{2, 3}, chess::Side::kWhite) ==
+        2);
+  CHECK(!attacks.isAttacked(chess::Position{3, 3}, chess::Side::kWhite));
+  CHECK(attacks.isAttacked(chess::Position{5, 5}, chess::Side::kBlack));
+  CHECK(!attacks.isAttacked(chess::Position{4, 5}, chess::Side::kBlack));
+}
+
+TEST_CASE("AttackMap agrees with underAttack") {
+  using namespace chess::pieces;
+  // clang-format off
+  constexpr chess::Board::BoardArray position{
+    R, E, E, E, K, E, E, R,
+    P, P, E, N, E, P, P, P,
+    E, E, P, E, E, Q, E, E,
+    E, E, E, p, P, E, E, E,
+    E, b, E, E, E, E, n, E,
+    E, E, n, E, E, q, E, E,
+    p, p, p, E, E, p, p, p,
+    r, E, E, E, k, E, E, r};
+  // clang-format on
+  const chess::Board board{position};
+  const chess::AttackMap attacks{board};
+  for (const chess::Position pos : chess::BoardPositions{}) {
+    for (const chess::Side side : {chess::Side::kWhite, chess::Side::kBlack}) {
+      const chess::UnderAttack expected = chess::underAttack(pos, side, board);
+      const chess::Side opponent = chess::opponentSide(side);
+      CHECK(attacks.attackerCount(pos, opponent) == expected.iNumAttackers);
+      CHECK(attacks.isAttacked(pos, opponent) == expected.bUnderAttack);
+      CHECK(chess::underAttack(pos, side, board, attacks) == expected);
+    }
+  }
+}
+
+TEST_CASE("AttackMap update and restore") {
+  using namespace chess::pieces;
+  chess::Board board;
+  chess::AttackMap attacks{board};
+  const chess::AttackMap initial = attacks;
+
+  // 1. e4, opening the diagonals of the bishop and the queen
+  board.setSquare(chess::Position{1, 4}, E);
+  board.setSquare(chess::Position{3, 4}, P);
+  const chess::AttackMap::Delta pawnMove = attacks.update(
+      board, chess::positionBit({1, 4}) | chess::positionBit({3, 4}));
+  CHECK(attacks == chess::AttackMap{board});
+  CHECK(attacks.isAttacked(chess::Position{4, 7}, chess::Side::kWhite));
+  CHECK(attacks.attacksFrom(chess::Position{0, 5}) ==
+        chess::bishopAttacks(5, board.occupied()));
+
+  // Bishop to a6, leaving the first row
+  board.setSquare(chess::Position{0, 5}, E);
+  board.setSquare(chess::Position{5, 0}, B);
+  const chess::AttackMap::Delta bishopMove = attacks.update(
+      board, chess::positionBit({0, 5}) | chess::positionBit({5, 0}));
+  CHECK(attacks == chess::AttackMap{board});
+
+  attacks.restore(bishopMove);
+  board.setSquare(chess::Position{5, 0}, E);
+  board.setSquare(chess::Position{0, 5}, B);
+  CHECK(attacks == chess::AttackMap{board});
+
+  attacks.restore(pawnMove);
+  CHECK(attacks == initial);
+}
+
+#endif
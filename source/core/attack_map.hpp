@@ -0,0 +1,74 @@
+#pragma once
+
+#include "board.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace chess {
+/// @brief Squares attacked by each side, with the number of attackers per
+///  square, built in one pass over the board.
+///
+/// Kings are not counted as attackers, matching underAttack. A slider attacks
+/// every square up to and including the first occupied one on each ray, and
+/// a pawn attacks its two diagonal squares whether they are occupied or not.
+///
+/// After a move the map can be brought up to date with update(), which only
+/// recomputes the pieces standing on the changed squares and the sliders
+/// whose rays pass through them. The Delta it returns undoes the update.
+class AttackMap {
+public:
+  /// Attacks of one square before an update
+  struct Change {
+    std::int8_t square = 0;
+    Side side = Side::kWhite;
+    Bitboard attacks = kEmptyBitboard;
+  };
+
+  /// The squares an update recomputed, with their previous attacks
+  struct Delta {
+    // Every piece but the two kings, plus the (at most four) squares of a
+    // castling move
+    static constexpr int kMaxChanges = 30 + 4;
+
+    std::array<Change, kMaxChanges> changes;
+    int size = 0;
+  };
+
+  AttackMap() = default;
+  explicit AttackMap(const Board &board);
+
+  /// Recomputes the attacks affected by changing the squares in @a changed,
+  /// @a board being the position after the change.
+  /// @return What restore() needs to revert this update.
+  Delta update(const Board &board, Bitboard changed);
+
+  /// Reverts the update that returned @a delta, which must be the last one.
+  void restore(const Delta &delta);
+
+  /// @return The squares attacked by at least one piece of side @a side.
+  [[nodiscard]] Bitboard attacked(Side side) const;
+
+  /// @return How many pieces of side @a side attack @a pos.
+  [[nodiscard]] int attackerCount(Position pos, Side side) const;
+
+  /// @return True if at least one piece of side @a side attacks @a pos.
+  [[nodiscard]] bool isAttacked(Position pos, Side side) const;
+
+  /// @return The squares attacked by the piece on @a pos, empty if there is
+  ///  no piece or it is a king.
+  [[nodiscard]] Bitboard attacksFrom(Position pos) const;
+
+  [[nodiscard]] bool operator==(const AttackMap &rhs) const = default;
+
+private:
+  void setAttacks(int square, Side side, Bitboard attacks);
+  void addAttacks(Bitboard attacks, Side side);
+  void removeAttacks(Bitboard attacks, Side side);
+
+  std::array<Bitboard, kNumPositions> mAttacksFrom{};
+  std::array<Side, kNumPositions> mOwners{};
+  std::array<Bitboard, 2> mAttacked{};
+  std::array<std::array<std::uint8_t, kNumPositions>, 2> mAttackerCounts{};
+};
+} // namespace chess
@@ -0,0 +1,343 @@
+#include "attacks.hpp"
+#include "board.hpp"
+
+#include <array>
+#include <cassert>
+#include <vector>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace chess {
+namespace {
+constexpr std::array<Position, 4> kRookDirections = {
+    Position{0, -1}, Position{0, 1}, Position{-1, 0}, Position{1, 0}};
+constexpr std::array<Position, 4> kBishopDirections = {
+    Position{1, 1}, Position{1, -1}, Position{-1, 1}, Position{-1, -1}};
+constexpr std::array<Position, 8> kKnightSteps = {
+    Position{1, -2},  Position{2, -1},  Position{2, 1},  Position{1, 2},
+    Position{-1, -2}, Position{-2, -1}, Position{-2, 1}, Position{-1, 2}};
+constexpr std::array<Position, 8> kKingSteps = {
+    Position{1, -1}, Position{1, 0},  Position{1, 1},   Position{0, 1},
+    Position{-1, 1}, Position{-1, 0}, Position{-1, -1}, Position{0, -1}};
+
+Position offset(const Position pos, const Position step) {
+  return Position{pos.iRow + step.iRow, pos.iColumn + step.iColumn};
+}
+
+Bitboard stepAttacks(const int square, const std::array<Position, 8> &steps) {
+  Bitboard attacks = kEmptyBitboard;
+  for (const Position step : steps) {
+    if (const Position to = offset(squareToPosition(square), step);
+        validBoardPosition(to)) {
+      attacks |= positionBit(to);
+    }
+  }
+  return attacks;
+}
+
+/// Walks every ray in @a directions square by square. Used to fill the magic
+/// tables, so speed does not matter here.
+Bitboard slidingAttacks(const int square, const Bitboard occupied,
+                        const std::array<Position, 4> &directions) {
+  Bitboard attacks = kEmptyBitboard;
+  for (const Position direction : directions) {
+    for (Position to = offset(squareToPosition(square), direction);
+         validBoardPosition(to); to = offset(to, direction)) {
+      attacks |= positionBit(to);
+      if (occupied & positionBit(to)) {
+        break;
+      }
+    }
+  }
+  return attacks;
+}
+
+/// @return The squares whose occupancy changes the attacks of a slider on
+///  @a square: the rays without their last square.
+Bitboard relevantOccupancy(const int square,
+                           const std::array<Position, 4> &directions) {
+  Bitboard mask = kEmptyBitboard;
+  for (const Position direction : directions) {
+    for (Position to = offset(squareToPosition(square), direction);
+         validBoardPosition(offset(to, direction));
+         to = offset(to, direction)) {
+      mask |= positionBit(to);
+    }
+  }
+  return mask;
+}
+
+/// Attack lookup for one square of one slider type. With BMI2 the table is
+/// indexed by PEXT of the occupancy, otherwise by a multiplicative magic.
+struct Magic {
+  Bitboard mask = kEmptyBitboard;
+  Bitboard magic = 0;
+  int shift = 0;
+  Bitboard *attacks = nullptr;
+
+  [[nodiscard]] unsigned index(const Bitboard occupied) const {
+#if defined(__BMI2__)
+    return static_cast<unsigned>(_pext_u64(occupied, mask));
+#else
+    return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+#endif
+  }
+};
+
+// Multipliers for the magic index, one per square. They were found with a
+// random search over sparse candidates; any multiplier that maps all the
+// relevant occupancies of a square without a destructive collision works.
+// clang-format off
+constexpr std::array<Bitboard, kNumPositions> kRookMultipliers = {
+    0x0080068051E04000ULL, 0x0040001000402000ULL, 0x0080100020008008ULL,
+    0x4E000A0010208440ULL, 0x4200040802002010ULL, 0x0100010008020400ULL,
+    0x9080608019000600ULL, 0x8100020080204100ULL, 0x4103800480400020ULL,
+    0x8015004004802100ULL, 0x000200108A002040ULL, 0x0801000821001000ULL,
+    0x0015000500080070ULL, 0x0120800400800200ULL, 0x0109000432001100ULL,
+    0x020080055B000080ULL, 0x0080004000402002ULL, 0x5260848020004008ULL,
+    0x2402020014402080ULL, 0x3000808010000802ULL, 0x0304018004810800ULL,
+    0x0000808004000200ULL, 0x0002040001500248ULL, 0x0012020000408401ULL,
+    0x8440008080004020ULL, 0x0804200840100040ULL, 0x0820008080201000ULL,
+    0x2080100100082100ULL, 0x0001000500100800ULL, 0x00A1000900028400ULL,
+    0x0100100400C80102ULL, 0x000001120000A044ULL, 0x800080C004800620ULL,
+    0x4040081000202000ULL, 0x0D08802008801000ULL, 0x1000800800801004ULL,
+    0x1004000801010010ULL, 0x0402800400800200ULL, 0x0004080204008110ULL,
+    0x0000404082000401ULL, 0x00C0118861408000ULL, 0x1100220081020048ULL,
+    0x09A0430420050010ULL, 0x0000082200420010ULL, 0x2110080004008080ULL,
+    0x2004201040680104ULL, 0x1106001451820008ULL, 0x0002224104820014ULL,
+    0x00800C8044210500ULL, 0x02A0200040100040ULL, 0x040100A0001E4100ULL,
+    0x00204023108A0200ULL, 0x2400080080040080ULL, 0x1289008400020900ULL,
+    0x0002088250010400ULL, 0x0001006084010200ULL, 0x0001023480002141ULL,
+    0x0006400021810015ULL, 0x8400100840200101ULL, 0x40003000A1000825ULL,
+    0x1002011008200402ULL, 0x100D000400080201ULL, 0x0020048806102904ULL,
+    0x8401000020804201ULL};
+
+constexpr std::array<Bitboard, kNumPositions> kBishopMultipliers = {
+    0x2008021012002502ULL, 0x04D0100110628400ULL, 0x21102080A1021010ULL,
+    0x2044041080000400ULL, 0x0004050402800000ULL, 0x0002010420109560ULL,
+    0x08040084500A0000ULL, 0x9401002104224008ULL, 0x40044350070B0100ULL,
+    0x90B00888088C1040ULL, 0x0100100440444012ULL, 0x80001104008A0940ULL,
+    0x1042920210504048ULL, 0x0000010420048200ULL, 0x000000A410221000ULL,
+    0x804800829C901001ULL, 0x0040002008010120ULL, 0x8802008424280205ULL,
+    0x200800010A040010ULL, 0x2420800802004008ULL, 0x0012011402A21220ULL,
+    0x2002028508022208ULL, 0x0486200049100802ULL, 0x2000211101080200ULL,
+    0x8020200044140C60ULL, 0x0810680C05080381ULL, 0x0001442028012400ULL,
+    0x4028088008020002ULL, 0x25C1001041004010ULL, 0x0401020049080140ULL,
+    0x0004004084210400ULL, 0x40010900104400A0ULL, 0x011011480004A800ULL,
+    0x0082020200A0680BULL, 0x0800203000080082ULL, 0x0005020081880080ULL,
+    0x1050120080001004ULL, 0x0020008880030810ULL, 0x2241180900008C30ULL,
+    0x0201451101012400ULL, 0x8444016008025000ULL, 0x0002080104000800ULL,
+    0x2801001490090200ULL, 0x0500142018001100ULL, 0x0300040408200400ULL,
+    0x0008008800820810ULL, 0x0804210204004212ULL, 0x000800A698800202ULL,
+    0x0411040202401000ULL, 0x0A008C051802000EULL, 0x1002A100A8040022ULL,
+    0x00000C0084042600ULL, 0x1000884048220000ULL, 0x0082200410208000ULL,
+    0x0222020441140022ULL, 0x1004080800408810ULL, 0x0022410801500201ULL,
+    0x010000410818020BULL, 0x2044000044040410ULL, 0x00200C0100208801ULL,
+    0x080800200A102400ULL, 0x000404C010020090ULL, 0x1002101418808C03ULL,
+    0x0011300081040020ULL};
+// clang-format on
+
+/// Fills @a magics and @a table for one slider type. The table holds one
+/// block per square, sized by the number of relevant occupancy bits.
+void initMagics(std::array<Magic, kNumPositions> &magics,
+                std::vector<Bitboard> &table,
+                const std::array<Position, 4> &directions,
+                const std::array<Bitboard, kNumPositions> &multipliers) {
+  std::size_t tableSize = 0;
+  for (int square = 0; square < kNumPositions; ++square) {
+    tableSize += std::size_t{1}
+                 << popCount(relevantOccupancy(square, directions));
+  }
+  table.assign(tableSize, kEmptyBitboard);
+
+  Bitboard *block = table.data();
+  for (int square = 0; square < kNumPositions; ++square) {
+    Magic &magic = magics[square];
+    magic.mask = relevantOccupancy(square, directions);
+    magic.magic = multipliers[square];
+    magic.shift = kNumPositions - popCount(magic.mask);
+    magic.attacks = block;
+
+    // Enumerate every subset of the mask (Carry-Rippler)
+    Bitboard subset = kEmptyBitboard;
+    do {
+      Bitboard &entry = magic.attacks[magic.index(subset)];
+      const Bitboard attacks = slidingAttacks(square, subset, directions);
+      assert(entry == kEmptyBitboard || entry == attacks);
+      entry = attacks;
+      subset = (subset - magic.mask) & magic.mask;
+    } while (subset != kEmptyBitboard);
+
+    block += std::size_t{1} << popCount(magic.mask);
+  }
+}
+
+/// @return The squares from @a square to the edge in @a direction, excluding
+///  @a square itself.
+Bitboard ray(const int square, const Position direction) {
+  Bitboard squares = kEmptyBitboard;
+  for (Position to = offset(squareToPosition(square), direction);
+       validBoardPosition(to); to = offset(to, direction)) {
+    squares |= positionBit(to);
+  }
+  return squares;
+}
+
+struct AttackTables {
+  std::array<Bitboard, kNumPositions> knight{};
+  std::array<Bitboard, kNumPositions> king{};
+  std::array<std::array<Bitboard, kNumPositions>, 2> pawn{};
+  std::array<Magic, kNumPositions> rookMagics{};
+  std::array<Magic, kNumPositions> bishopMagics{};
+  std::vector<Bitboard> rookTable;
+  std::vector<Bitboard> bishopTable;
+  std::array<std::array<Bitboard, kNumPositions>, kNumPositions> between{};
+  std::array<std::array<Bitboard, kNumPositions>, kNumPositions> line{};
+
+  AttackTables() {
+    for (int square = 0; square < kNumPositions; ++square) {
+      knight[square] = stepAttacks(square, kKnightSteps);
+      king[square] = stepAttacks(square, kKingSteps);
+
+      const Position pos = squareToPosition(square);
+      for (const int column : {pos.iColumn - 1, pos.iColumn + 1}) {
+        if (const Position white{pos.iRow + 1, column};
+            validBoardPosition(white)) {
+          pawn[static_cast<int>(Side::kWhite)][square] |= positionBit(white);
+        }
+        if (const Position black{pos.iRow - 1, column};
+            validBoardPosition(black)) {
+          pawn[static_cast<int>(Side::kBlack)][square] |= positionBit(black);
+        }
+      }
+    }
+
+    initMagics(rookMagics, rookTable, kRookDirections, kRookMultipliers);
+    initMagics(bishopMagics, bishopTable, kBishopDirections,
+               kBishopMultipliers);
+
+    // Walk every direction from every square; the eight king steps are
+    // exactly the eight directions
+    for (int from = 0; from < kNumPositions; ++from) {
+      for (const Position direction : kKingSteps) {
+        const Position opposite{-direction.iRow, -direction.iColumn};
+        const Bitboard fullLine =
+            ray(from, direction) | ray(from, opposite) | squareBit(from);
+        Bitboard passed = kEmptyBitboard;
+        for (Position to = offset(squareToPosition(from), direction);
+             validBoardPosition(to); to = offset(to, direction)) {
+          between[from][positionToSquare(to)] = passed;
+          line[from][positionToSquare(to)] = fullLine;
+          passed |= positionBit(to);
+        }
+      }
+    }
+  }
+};
+
+const AttackTables &tables() {
+  static const AttackTables kTables;
+  return kTables;
+}
+} // namespace
+
+Bitboard knightAttacks(const int square) { return tables().knight[square]; }
+
+Bitboard kingAttacks(const int square) { return tables().king[square]; }
+
+Bitboard pawnAttacks(const Side side, const int square) {
+  return tables().pawn[static_cast<int>(side)][square];
+}
+
+Bitboard rookAttacks(const int square, const Bitboard occupied) {
+  const Magic &magic = tables().rookMagics[square];
+  return magic.attacks[magic.index(occupied)];
+}
+
+Bitboard bishopAttacks(const int square, const Bitboard occupied) {
+  const Magic &magic = tables().bishopMagics[square];
+  return magic.attacks[magic.index(occupied)];
+}
+
+Bitboard queenAttacks(const int square, const Bitboard occupied) {
+  return rookAttacks(square, occupied) | bishopAttacks(square, occupied);
+}
+
+Bitboard squaresBetween(const int from, const int to) {
+  return tables().between[from][to];
+}
+
+Bitboard lineThrough(const int from, const int to) {
+  return tables().line[from][to];
+}
+
+} // namespace chess
+
+#if defined(UNIT_TEST)
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+class XorShift64 {
+public:
+  chess::Bitboard next() {
+    mState ^= mState >> 12;
+    mState ^= mState << 25;
+    mState ^= mState >> 27;
+    return mState * 2685821657736338717ULL;
+  }
+
+private:
+  chess::Bitboard mState = 1070372;
+};
+} // namespace
+
+TEST_CASE("attacks leapers") {
+  // Knight on A1 attacks B3 and C2
+  CHECK(chess::knightAttacks(0) ==
+        (chess::squareBit(17) | chess::squareBit(10)));
+  CHECK(chess::popCount(chess::knightAttacks(27)) == 8);
+  CHECK(chess::popCount(chess::kingAttacks(0)) == 3);
+  CHECK(chess::popCount(chess::kingAttacks(27)) == 8);
+  // White pawn on E2 attacks D3 and F3, black pawn on E7 attacks D6 and F6
+  CHECK(chess::pawnAttacks(chess::Side::kWhite, 12) ==
+        (chess::squareBit(19) | chess::squareBit(21)));
+  CHECK(chess::pawnAttacks(chess::Side::kBlack, 52) ==
+        (chess::squareBit(43) | chess::squareBit(45)));
+  CHECK(chess::pawnAttacks(chess::Side::kWhite, 8) == chess::squareBit(17));
+}
+
+TEST_CASE("attacks sliders match ray walk") {
+  XorShift64 random;
+  for (int square = 0; square < chess::kNumPositions; ++square) {
+    for (int k = 0; k < 64; ++k) {
+      const chess::Bitboard occupied = random.next() & random.next();
+      CHECK(chess::rookAttacks(square, occupied) ==
+            chess::slidingAttacks(square, occupied, chess::kRookDirections));
+      CHECK(chess::bishopAttacks(square, occupied) ==
+            chess::slidingAttacks(square, occupied, chess::kBishopDirections));
+    }
+  }
+  // Empty board: a rook always sees 14 squares
+  CHECK(chess::popCount(chess::rookAttacks(27, chess::kEmptyBitboard)) == 14);
+  CHECK(chess::popCount(chess::bishopAttacks(0, chess::kEmptyBitboard)) == 7);
+}
+
+TEST_CASE("attacks lines") {
+  // A1 to H8: B2 through G7
+  CHECK(chess::squaresBetween(0, 63) == 0x0040201008040200ULL);
+  CHECK(chess::lineThrough(0, 63) == 0x8040201008040201ULL);
+  CHECK(chess::lineThrough(63, 0) == chess::lineThrough(0, 63));
+  // E1 to E8 on the E file, C1 and D1 next to each other
+  CHECK(chess::squaresBetween(4, 60) == 0x0010101010101000ULL);
+  CHECK(chess::squaresBetween(2, 3) == chess::kEmptyBitboard);
+  CHECK(chess::lineThrough(2, 3) == 0xFFULL);
+  // A knight's step shares no line
+  CHECK(chess::squaresBetween(0, 17) == chess::kEmptyBitboard);
+  CHECK(chess::lineThrough(0, 17) == chess::kEmptyBitboard);
+  CHECK(chess::lineThrough(5, 5) == chess::kEmptyBitboard);
+}
+
+#endif
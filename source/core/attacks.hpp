@@ -0,0 +1,35 @@
+#pragma once
+
+#include "bitboard.hpp"
+#include "pieces.hpp"
+
+namespace chess {
+/// @return The squares a knight on @a square attacks.
+[[nodiscard]] Bitboard knightAttacks(int square);
+
+/// @return The squares a king on @a square attacks.
+[[nodiscard]] Bitboard kingAttacks(int square);
+
+/// @return The squares a pawn of side @a side on @a square attacks. This is
+///  also the set of squares from which an opponent pawn attacks @a square.
+[[nodiscard]] Bitboard pawnAttacks(Side side, int square);
+
+/// @return The squares a rook on @a square attacks, given the pieces in
+///  @a occupied. Each ray stops at, and includes, the first occupied square.
+[[nodiscard]] Bitboard rookAttacks(int square, Bitboard occupied);
+
+/// @return The squares a bishop on @a square attacks, given the pieces in
+///  @a occupied. Each ray stops at, and includes, the first occupied square.
+[[nodiscard]] Bitboard bishopAttacks(int square, Bitboard occupied);
+
+/// @return The union of rookAttacks and bishopAttacks.
+[[nodiscard]] Bitboard queenAttacks(int square, Bitboard occupied);
+
+/// @return The squares strictly between @a from and @a to when they share a
+///  row, column or diagonal, otherwise an empty set.
+[[nodiscard]] Bitboard squaresBetween(int from, int to);
+
+/// @return The full line through @a from and @a to, edge to edge, when they
+///  share a row, column or diagonal, otherwise an empty set.
+[[nodiscard]] Bitboard lineThrough(int from, int to);
+} // namespace chess
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+
+namespace chess {
+/// A set of squares, one bit per square. Bit 0 is A1, bit 7 is H1 and bit 63
+/// is H8, matching the row-major layout of Board::BoardArray.
+using Bitboard = std::uint64_t;
+
+constexpr Bitboard kEmptyBitboard = 0;
+
+/// @return A bitboard with only the bit of @a square set.
+/// @param square Linear square index in the range [0, 63]
+[[nodiscard]] constexpr Bitboard squareBit(const int square) {
+  assert(square >= 0 && square < 64);
+  return Bitboard{1} << square;
+}
+
+[[nodiscard]] constexpr bool testSquare(const Bitboard bitboard,
+                                        const int square) {
+  return (bitboard & squareBit(square)) != 0;
+}
+
+[[nodiscard]] constexpr int popCount(const Bitboard bitboard) {
+  return std::popcount(bitboard);
+}
+
+/// @return The index of the least significant set bit.
+/// @param bitboard Must not be empty
+[[nodiscard]] constexpr int lsb(const Bitboard bitboard) {
+  assert(bitboard != 0);
+  return std::countr_zero(bitboard);
+}
+
+/// Removes the least significant set bit of @a bitboard and returns its index.
+/// @param bitboard Must not be empty
+constexpr int popLsb(Bitboard &bitboard) {
+  const int square = lsb(bitboard);
+  bitboard &= bitboard - 1;
+  return square;
+}
+
+/// @brief Range over the square indices set in a bitboard, in increasing
+///  order. Only the occupied squares are visited.
+class BitboardSquares {
+public:
+  struct EndSentinel {};
+  class Iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = int;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr Iterator() = default;
+    constexpr explicit Iterator(const Bitboard bitboard) : mBits(bitboard) {}
+
+    [[nodiscard]] constexpr int operator*() const { return lsb(mBits); }
+    constexpr Iterator &operator++() {
+      mBits &= mBits - 1;
+      return *this;
+    }
+    constexpr Iterator operator++(int) {
+      const auto original = *this;
+      ++(*this);
+      return original;
+    }
+
+    [[nodiscard]] constexpr bool operator==(const Iterator &) const = default;
+    [[nodiscard]] constexpr bool operator==(EndSentinel) const {
+      return mBits == 0;
+    }
+
+  private:
+    Bitboard mBits = kEmptyBitboard;
+  };
+
+  constexpr explicit BitboardSquares(const Bitboard bitboard)
+      : mBits(bitboard) {}
+
+  [[nodiscard]] constexpr Iterator begin() const { return Iterator{mBits}; }
+  [[nodiscard]] constexpr EndSentinel end() const { return EndSentinel{}; }
+
+private:
+  Bitboard mBits;
+};
+} // namespace chess
@@ -1,6 +1,8 @@
 #include "board.hpp"
 #include "board_positions.hpp"
+#include "zobrist.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <map>
@@ -19,6 +21,11 @@ void affirmIndices(const int row, const int col) {
 /// @param col Must be >= 0 and less than 8
 int linearIndex(const int row, const int col) { return row * kNumCols + col; }
 
+/// @return The piece list holding @a piece.
+int pieceListIndex(const PieceWithSide piece) {
+  return static_cast<int>(piece.mSide) * 6 + static_cast<int>(piece.mPiece);
+}
+
 const std::unordered_map<char, PieceWithSide> kCharToPieces = {
     {'P', pieces::P}, {'p', pieces::p}, {'B', pieces::B}, {'b', pieces::b},
     {'R', pieces::R}, {'r', pieces::r}, {'N', pieces::N}, {'n', pieces::n},
@@ -30,8 +37,13 @@ const std::map<PieceWithSide, char> kPiecesToChar = {
     {pieces::Q, 'Q'}, {pieces::q, 'q'}, {pieces::K, 'K'}, {pieces::k, 'k'}};
 } // namespace
 
-Board::Board(std::array<SquareState, kNumPositions> initial_board)
-    : mBoard(initial_board) {}
+Board::Board() : Board(pieces::kInitialBoardState) {}
+
+Board::Board(std::array<SquareState, kNumPositions> initial_board) {
+  for (const Position pos : BoardPositions{}) {
+    setSquare(pos, initial_board[linearIndex(pos.iRow, pos.iColumn)]);
+  }
+}
 
 std::ostream &operator<<(std::ostream &stream, const Position &pos) {
   stream << static_cast<char>(pos.iColumn + 'A')
@@ -49,22 +61,78 @@ std::ostream &operator<<(std::ostream &stream, const SquareState &state) {
   return stream;
 }
 
-SquareState &Board::operator()(const int row, const int col) {
-  affirmIndices(row, col);
-  return mBoard[linearIndex(row, col)];
-}
-
 SquareState Board::operator()(const int row, const int col) const {
   affirmIndices(row, col);
-  return mBoard[linearIndex(row, col)];
+  return decodePiece(mBoard[linearIndex(row, col)]);
 }
 
-SquareState &Board::operator()(const Position pos) {
+SquareState Board::operator()(const Position pos) const {
   return (*this)(pos.iRow, pos.iColumn);
 }
 
-SquareState Board::operator()(const Position pos) const {
-  return (*this)(pos.iRow, pos.iColumn);
+void Board::setSquare(const Position pos, const SquareState state) {
+  affirmIndices(pos.iRow, pos.iColumn);
+  PieceCode &square = mBoard[linearIndex(pos.iRow, pos.iColumn)];
+  const Bitboard bit = positionBit(pos);
+  const int index = positionToSquare(pos);
+  if (const SquareState previous = decodePiece(square)) {
+    mPieceBitboards[static_cast<int>(previous->mPiece)] &= ~bit;
+    mSideBitboards[static_cast<int>(previous->mSide)] &= ~bit;
+    mHash ^= zobrist::pieceKey(*previous, index);
+    removeFromPieceList(*previous, index);
+  }
+  if (state) {
+    mPieceBitboards[static_cast<int>(state->mPiece)] |= bit;
+    mSideBitboards[static_cast<int>(state->mSide)] |= bit;
+    mHash ^= zobrist::pieceKey(*state, index);
+    addToPieceList(*state, index);
+  }
+  square = encodePiece(state);
+}
+
+void Board::addToPieceList(const PieceWithSide piece, const int square) {
+  const int list = pieceListIndex(piece);
+  assert(mPieceCounts[list] < kMaxPiecesOfKind);
+  mPieceListIndex[square] = mPieceCounts[list];
+  mPieceLists[list][mPieceCounts[list]++] = static_cast<std::int8_t>(square);
+}
+
+void Board::removeFromPieceList(const PieceWithSide piece, const int square) {
+  // Move the last entry into the freed slot
+  const int list = pieceListIndex(piece);
+  const std::int8_t last = mPieceLists[list][--mPieceCounts[list]];
+  mPieceLists[list][mPieceListIndex[square]] = last;
+  mPieceListIndex[last] = mPieceListIndex[square];
+}
+
+std::span<const std::int8_t> Board::pieceSquares(const Piece piece,
+                                                 const Side side) const {
+  const int list = pieceListIndex({.mPiece = piece, .mSide = side});
+  return {mPieceLists[list].data(),
+          static_cast<std::size_t>(mPieceCounts[list])};
+}
+
+std::optional<int> Board::kingSquare(const Side side) const {
+  const std::span<const std::int8_t> kings = pieceSquares(Piece::kKing, side);
+  return kings.empty() ? std::nullopt : std::make_optional<int>(kings.front());
+}
+
+Bitboard Board::pieces(const Piece piece, const Side side) const {
+  return mPieceBitboards[static_cast<int>(piece)] &
+         mSideBitboards[static_cast<int>(side)];
+}
+
+Bitboard Board::pieces(const Side side) const {
+  return mSideBitboards[static_cast<int>(side)];
+}
+
+Bitboard Board::pieces(const Piece piece) const {
+  return mPieceBitboards[static_cast<int>(piece)];
+}
+
+Bitboard Board::occupied() const {
+  return mSideBitboards[static_cast<int>(Side::kWhite)] |
+         mSideBitboards[static_cast<int>(Side::kBlack)];
 }
 
 SquareState Board::getPieceConsiderMove(
@@ -87,11 +155,12 @@ SquareState Board::getPieceConsiderMove(
   }
 }
 
-Board::Iterator::Iterator(const BoardArray &board)
+Board::Iterator::Iterator(const PackedArray &board)
     : mPos(Position{.iRow = 0, .iColumn = 0}), mBoard(board) {}
 
 Board::Iterator::value_type Board::Iterator::operator*() const {
-  return {mBoard.get()[linearIndex(mPos.iRow, mPos.iColumn)], mPos};
+  return {decodePiece(mBoard.get()[linearIndex(mPos.iRow, mPos.iColumn)]),
+          mPos};
 }
 
 bool Board::Iterator::operator==(const Iterator &rhs) const {
@@ -121,7 +190,17 @@ Board::Iterator Board::begin() const { return Iterator{mBoard}; }
 
 Board::EndSentinel Board::end() const { return EndSentinel{}; }
 
-const Board::BoardArray &Board::boardState() const { return mBoard; }
+std::uint64_t Board::hash() const { return mHash; }
+
+Board::BoardArray Board::boardState() const {
+  BoardArray state;
+  std::transform(mBoard.cbegin(), mBoard.cend(), state.begin(), decodePiece);
+  return state;
+}
+
+const Board::PackedArray &Board::packedState() const { return mBoard; }
+
+bool Board::operator==(const Board &rhs) const { return mBoard == rhs.mBoard; }
 
 PieceWithSide charToPiece(const char piece) { return kCharToPieces.at(piece); }
 
@@ -133,16 +212,8 @@ bool validBoardPosition(const Position &pos) {
 }
 
 Position findKing(const Board &board, const Side side) {
-  const PieceWithSide chKing{.mPiece = Piece::kKing, .mSide = side};
-  Position king;
-
-  for (const Position pos : BoardPositions{}) {
-    if (const SquareState square = board(pos); square && *square == chKing) {
-      king = pos;
-    }
-  }
-
-  return king;
+  const std::optional<int> king = board.kingSquare(side);
+  return king ? squareToPosition(*king) : Position{};
 }
 
 Side opponentSide(const Side side) {
@@ -278,6 +349,113 @@ TEST_CASE("Board findKing") {
   CHECK(blackKingPosition == chess::Position{7, 4});
 }
 
+TEST_CASE("Board piece lists") {
+  chess::Board board;
+  CHECK(board.pieceSquares(chess::Piece::kPawn, chess::Side::kWhite).size() ==
+        8);
+  CHECK(board.pieceSquares(chess::Piece::kQueen, chess::Side::kBlack).size() ==
+        1);
+  CHECK(board.kingSquare(chess::Side::kWhite) == 4);
+  CHECK(board.kingSquare(chess::Side::kBlack) == 60);
+
+  // Knight takes a pawn, then the king moves
+  board.setSquare(chess::Position{0, 1}, chess::pieces::E);
+  board.setSquare(chess::Position{6, 2}, chess::pieces::N);
+  board.setSquare(chess::Position{0, 4}, chess::pieces::E);
+  board.setSquare(chess::Position{1, 4}, chess::pieces::K);
+  CHECK(board.kingSquare(chess::Side::kWhite) == 12);
+  CHECK(findKing(board, chess::Side::kWhite) == chess::Position{1, 4});
+
+  for (const chess::Side side : {chess::Side::kWhite, chess::Side::kBlack}) {
+    for (const chess::Piece piece :
+         {chess::Piece::kPawn, chess::Piece::kKnight, chess::Piece::kBishop,
+          chess::Piece::kRook, chess::Piece::kQueen, chess::Piece::kKing}) {
+      chess::Bitboard fromList = chess::kEmptyBitboard;
+      for (const int square : board.pieceSquares(piece, side)) {
+        fromList |= chess::squareBit(square);
+      }
+      CHECK(fromList == board.pieces(piece, side));
+    }
+  }
+
+  board.setSquare(chess::Position{1, 4}, chess::pieces::E);
+  CHECK(!board.kingSquare(chess::Side::kWhite).has_value());
+  CHECK(findKing(board, chess::Side::kWhite) == chess::Position{});
+}
+
+TEST_CASE("Board bitboards initial board") {
+  const chess::Board board;
+  CHECK(board.occupied() == 0xFFFF00000000FFFFULL);
+  CHECK(board.pieces(chess::Side::kWhite) == 0x000000000000FFFFULL);
+  CHECK(board.pieces(chess::Side::kBlack) == 0xFFFF000000000000ULL);
+  CHECK(board.pieces(chess::Piece::kPawn, chess::Side::kWhite) ==
+        0x000000000000FF00ULL);
+  CHECK(board.pieces(chess::Piece::kPawn, chess::Side::kBlack) ==
+        0x00FF000000000000ULL);
+  CHECK(board.pieces(chess::Piece::kRook) == 0x8100000000000081ULL);
+  CHECK(board.pieces(chess::Piece::kKing, chess::Side::kWhite) ==
+        chess::positionBit(chess::Position{0, 4}));
+  CHECK(board.pieces(chess::Piece::kQueen, chess::Side::kBlack) ==
+        chess::positionBit(chess::Position{7, 3}));
+}
+
+TEST_CASE("Board setSquare keeps bitboards in sync") {
+  chess::Board board;
+  const chess::Position e2{1, 4};
+  const chess::Position e4{3, 4};
+  const chess::Position d7{6, 3};
+
+  board.setSquare(e4, board(e2));
+  board.setSquare(e2, chess::pieces::E);
+  CHECK(board(e4) == chess::pieces::P);
+  CHECK(!board(e2).has_value());
+  CHECK(chess::testSquare(board.pieces(chess::Piece::kPawn, chess::Side::kWhite),
+                          chess::positionToSquare(e4)));
+  CHECK(!chess::testSquare(board.occupied(), chess::positionToSquare(e2)));
+
+  // Capture: the black pawn replaces the white one
+  board.setSquare(e4, board(d7));
+  board.setSquare(d7, chess::pieces::E);
+  CHECK(chess::popCount(board.pieces(chess::Side::kWhite)) == 15);
+  CHECK(chess::popCount(board.pieces(chess::Side::kBlack)) == 16);
+  CHECK(chess::testSquare(board.pieces(chess::Piece::kPawn, chess::Side::kBlack),
+                          chess::positionToSquare(e4)));
+
+  int count = 0;
+  for (const int square : chess::BitboardSquares{board.pieces(
+           chess::Piece::kPawn, chess::Side::kBlack)}) {
+    CHECK(board(chess::squareToPosition(square)) == chess::pieces::p);
+    ++count;
+  }
+  CHECK(count == 8);
+}
+
+TEST_CASE("Board packed square encoding") {
+  using namespace chess::pieces;
+  static_assert(sizeof(chess::Board::PackedArray) == 64);
+  static_assert(chess::encodePiece(E) == chess::PieceCode::kEmpty);
+  static_assert(!chess::decodePiece(chess::PieceCode::kEmpty).has_value());
+  for (const chess::PieceWithSide piece : {P, R, N, B, Q, K, p, r, n, b, q, k}) {
+    const chess::PieceCode code = chess::encodePiece(piece);
+    CHECK(code != chess::PieceCode::kEmpty);
+    CHECK(static_cast<int>(code) < 16);
+    CHECK(chess::decodePiece(code) == piece);
+  }
+}
+
+TEST_CASE("Board equality and boardState") {
+  const chess::Board board;
+  CHECK(board.boardState() == chess::pieces::kInitialBoardState);
+  CHECK(board == chess::Board{chess::pieces::kInitialBoardState});
+  CHECK(board.packedState()[0] == chess::encodePiece(chess::pieces::R));
+
+  chess::Board moved;
+  moved.setSquare(chess::Position{1, 4}, chess::pieces::E);
+  CHECK(!(moved == board));
+  moved.setSquare(chess::Position{1, 4}, chess::pieces::P);
+  CHECK(moved == board);
+}
+
 TEST_CASE("Board opponentSide") {
   CHECK(chess::opponentSide(chess::Side::kWhite) == chess::Side::kBlack);
   CHECK(chess::opponentSide(chess::Side::kBlack) == chess::Side::kWhite);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "bitboard.hpp"
 #include "pieces.hpp"
 
 #include <array>
@@ -7,6 +8,7 @@
 #include <initializer_list>
 #include <optional>
 #include <ostream>
+#include <span>
 
 namespace chess {
 constexpr int kNumRows = 8;
@@ -23,6 +25,20 @@ struct Position {
 
 std::ostream &operator<<(std::ostream &stream, const Position &pos);
 
+/// @return The linear square index of @a pos, see Bitboard for the layout.
+[[nodiscard]] constexpr int positionToSquare(const Position pos) {
+  return pos.iRow * kNumCols + pos.iColumn;
+}
+
+/// @return The Position of the linear square index @a square.
+[[nodiscard]] constexpr Position squareToPosition(const int square) {
+  return Position{.iRow = square / kNumCols, .iColumn = square % kNumCols};
+}
+
+[[nodiscard]] constexpr Bitboard positionBit(const Position pos) {
+  return squareBit(positionToSquare(pos));
+}
+
 struct IntendedMove {
   PieceWithSide piece;
   Position from;
@@ -46,21 +62,51 @@ constexpr std::array<SquareState, kNumPositions> kInitialBoardState = {
 class Board {
 public:
   using BoardArray = std::array<SquareState, kNumPositions>;
+  using PackedArray = std::array<PieceCode, kNumPositions>;
 
-  Board() = default;
+  Board();
   Board(BoardArray initial_board);
 
-  [[nodiscard]] SquareState &operator()(int row, int col);
   [[nodiscard]] SquareState operator()(int row, int col) const;
-
-  [[nodiscard]] SquareState &operator()(Position pos);
   [[nodiscard]] SquareState operator()(Position pos) const;
 
+  /// Places @a state on @a pos, keeping the bitboards in sync.
+  void setSquare(Position pos, SquareState state);
+
+  /// @return The squares holding a @a piece of side @a side.
+  [[nodiscard]] Bitboard pieces(Piece piece, Side side) const;
+  /// @return The squares holding a piece of side @a side.
+  [[nodiscard]] Bitboard pieces(Side side) const;
+  /// @return The squares holding a @a piece of either side.
+  [[nodiscard]] Bitboard pieces(Piece piece) const;
+  /// @return The squares holding any piece.
+  [[nodiscard]] Bitboard occupied() const;
+
+  /// @return The linear squares holding a @a piece of side @a side, in no
+  ///  particular order.
+  [[nodiscard]] std::span<const std::int8_t> pieceSquares(Piece piece,
+                                                          Side side) const;
+
+  /// @return The linear square of the king of side @a side, or std::nullopt
+  ///  if that side has no king.
+  [[nodiscard]] std::optional<int> kingSquare(Side side) const;
+
+  /// @return The Zobrist key of the pieces on the board, updated by
+  ///  setSquare. Side to move and castling rights are keyed by Game.
+  [[nodiscard]] std::uint64_t hash() const;
+
   [[nodiscard]] SquareState getPieceConsiderMove(
       Position pos,
       const std::optional<IntendedMove> &intended_move = std::nullopt) const;
 
-  [[nodiscard]] const BoardArray &boardState() const;
+  /// @return The decoded contents of every square, in row-major order.
+  [[nodiscard]] BoardArray boardState() const;
+
+  /// @return The one-byte-per-square mailbox, in row-major order.
+  [[nodiscard]] const PackedArray &packedState() const;
+
+  /// Two boards are equal when every square holds the same piece.
+  [[nodiscard]] bool operator==(const Board &rhs) const;
 
   struct EndSentinel {};
   class Iterator {
@@ -69,7 +115,7 @@ public:
     using value_type = std::pair<SquareState, Position>;
     using difference_type = std::ptrdiff_t;
 
-    Iterator(const BoardArray &board);
+    Iterator(const PackedArray &board);
 
     [[nodiscard]] value_type operator*() const;
     Iterator &operator++();
@@ -80,14 +126,30 @@ public:
 
   private:
     Position mPos{.iRow = 0, .iColumn = 0};
-    std::reference_wrapper<const BoardArray> mBoard;
+    std::reference_wrapper<const PackedArray> mBoard;
   };
 
   [[nodiscard]] Iterator begin() const;
   [[nodiscard]] EndSentinel end() const;
 
+  /// The most pieces of one kind a side can have: the initial ones plus
+  /// eight promoted pawns.
+  static constexpr int kMaxPiecesOfKind = 10;
+
 private:
-  BoardArray mBoard = pieces::kInitialBoardState;
+  void addToPieceList(PieceWithSide piece, int square);
+  void removeFromPieceList(PieceWithSide piece, int square);
+
+  alignas(64) PackedArray mBoard{};
+  std::array<Bitboard, 6> mPieceBitboards{};
+  std::array<Bitboard, 2> mSideBitboards{};
+  std::uint64_t mHash = 0;
+
+  // Squares of every kind of piece, indexed by side * 6 + piece, and the
+  // position of each occupied square within its list
+  std::array<std::array<std::int8_t, kMaxPiecesOfKind>, 12> mPieceLists{};
+  std::array<std::int8_t, 12> mPieceCounts{};
+  std::array<std::int8_t, kNumPositions> mPieceListIndex{};
 };
 
 /// @brief Converts a character representation to a PieceWithSide.
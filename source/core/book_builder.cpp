@@ -0,0 +1,344 @@
+#include "book_builder.hpp"
+#include "byte_order.hpp"
+#include "game.hpp"
+#include "game_archive.hpp"
+#include "load_save.hpp"
+#include "opening_book.hpp"
+#include "pgn.hpp"
+#include "sorted_runs.hpp"
+#include "validation.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+
+namespace chess {
+namespace {
+/// Bytes written to a file at a time
+constexpr std::size_t kWriteSize = std::size_t{1} << 16;
+
+struct BookRecord {
+  std::uint64_t key = 0;
+  std::uint16_t move = 0;
+  std::uint16_t score = 0;
+
+  auto operator<=>(const BookRecord &) const = default;
+};
+
+/// A BookRecord in a run file: the key, the move and the score
+struct BookRecordFormat {
+  using Record = BookRecord;
+  static constexpr std::size_t kSize = 12;
+
+  static void append(std::vector<std::byte> &bytes, const BookRecord &record) {
+    appendLittleEndian(bytes, record.key);
+    appendLittleEndian(bytes, record.move);
+    appendLittleEndian(bytes, record.score);
+  }
+
+  static BookRecord read(const std::span<const std::byte> bytes,
+                         const std::size_t offset) {
+    return {.key = readLittleEndian<std::uint64_t>(bytes, offset),
+            .move = readLittleEndian<std::uint16_t>(bytes, offset + 8),
+            .score = readLittleEndian<std::uint16_t>(bytes, offset + 10)};
+  }
+};
+
+using Runs = SortedRuns<BookRecordFormat>;
+
+/// A game read from one of the inputs, ready to be replayed
+struct InputGame {
+  std::string fen;
+  std::vector<Move> moves;
+  /// The score of white's moves, 2 for a win, 1 for a draw or an unknown
+  /// result and 0 for a loss
+  std::uint16_t whiteScore = 1;
+  bool complete = true;
+};
+
+/// One input file, kept open while its games are replayed
+struct Input {
+  std::filesystem::path file;
+  std::unique_ptr<GameArchive> archive;
+  std::unique_ptr<MappedFile> pgn;
+  std::vector<std::string_view> pgnGames;
+
+  [[nodiscard]] std::size_t size() const {
+    if (archive) {
+      return archive->size();
+    }
+    return pgn ? pgnGames.size() : 1;
+  }
+};
+
+/// @throws GameException if @a file can not be opened or is not a game file.
+Input openInput(const std::filesystem::path &file) {
+  Input input{.file = file};
+  if (file.extension() == kArchiveExtension) {
+    input.archive = std::make_unique<GameArchive>(file);
+  } else if (file.extension() == ".pgn") {
+    input.pgn = std::make_unique<MappedFile>(file);
+    input.pgnGames = splitPgnGames(input.pgn->text());
+  } else if (file.extension() == ".dat") {
+    // The game itself is read when its turn comes
+    if (!std::ifstream{file}) {
+      throw GameException("Can't open " + file.string());
+    }
+  } else {
+    throw GameException(file.string() + " is not a game file");
+  }
+  return input;
+}
+
+/// @throws GameException if an archived game is damaged.
+InputGame readInputGame(const Input &input, const std::size_t index) {
+  InputGame game;
+  if (input.archive) {
+    const ArchivedGame archived = (*input.archive)[index];
+    game.fen = archived.fen();
+    for (std::size_t ply = 0; ply < archived.moveCount(); ply++) {
+      game.moves.push_back(archived.move(ply));
+    }
+  } else if (input.pgn) {
+    PgnGame pgn_game = parsePgnGame(input.pgnGames[index]);
+    game.fen = std::move(pgn_game.fen);
+    game.moves = std::move(pgn_game.moves);
+    game.complete = pgn_game.error.empty();
+    if (pgn_game.result == "1-0") {
+      game.whiteScore = 2;
+    } else if (pgn_game.result == "0-1") {
+      game.whiteScore = 0;
+    }
+  } else {
+    const LoadedGame loaded = readGame(input.file);
+    if (const std::string fen = loaded.game.initialState().toFen();
+        fen != kStartFen) {
+      game.fen = fen;
+    }
+    for (const Game::Round &round : loaded.game.rounds) {
+      for (const std::optional<Move> &move :
+           {round.white_move, round.black_move}) {
+        if (move) {
+          game.moves.push_back(*move);
+        }
+      }
+    }
+    game.complete = loaded.error.empty();
+  }
+  return game;
+}
+
+/// @brief Adds a record for each move of @a game up to @a max_ply.
+/// @return False if the game stops at an illegal move.
+bool addRecords(const InputGame &game, const std::uint32_t max_ply,
+                std::vector<BookRecord> &records) {
+  GameState state =
+      game.fen.empty() ? GameState{} : GameState::fromFen(game.fen);
+  const std::size_t plies = std::min<std::size_t>(max_ply, game.moves.size());
+  for (std::size_t ply = 0; ply < plies; ply++) {
+    const Move move = game.moves[ply];
+    const MoveValidation result = validateMove(state, move);
+    if (!result.valid() || result.move != move) {
+      return false;
+    }
+    const std::uint16_t score = state.sideToMove() == Side::kWhite
+                                    ? game.whiteScore
+                                    : 2 - game.whiteScore;
+    records.push_back({.key = polyglotKey(state),
+                       .move = toPolyglotMove(move),
+                       .score = score});
+    state.makeMove(move);
+  }
+  return game.complete;
+}
+
+/// @brief Merges the sorted @a runs into the Polyglot book @a book.
+/// @return The number of book entries written.
+std::size_t mergeRuns(const Runs &runs, const std::filesystem::path &book) {
+  std::ofstream stream(book, std::ios::binary | std::ios::trunc);
+  if (!stream) {
+    throw GameException("Can't create " + book.string());
+  }
+
+  // The moves of one position with their total score
+  std::vector<std::pair<std::uint16_t, std::uint64_t>> moves;
+  std::uint64_t key = 0;
+  std::vector<std::byte> bytes;
+  std::size_t entries = 0;
+  const auto flush = [&] {
+    std::ranges::stable_sort(moves, [](const auto &a, const auto &b) {
+      return a.second > b.second;
+    });
+    const std::uint64_t heaviest = moves.empty() ? 0 : moves.front().second;
+    for (const auto &[move, score] : moves) {
+      // Weights only matter relative to the other moves of the position
+      std::uint64_t weight = score;
+      if (heaviest > 0xFFFF) {
+        weight = std::max<std::uint64_t>(score > 0, score * 0xFFFF / heaviest);
+      }
+      appendBigEndian(bytes, key);
+      appendBigEndian(bytes, move);
+      appendBigEndian(bytes, static_cast<std::uint16_t>(weight));
+      appendBigEndian(bytes, std::uint32_t{0});
+    }
+    entries += moves.size();
+    moves.clear();
+    if (bytes.size() >= kWriteSize) {
+      writeBytes(stream, bytes);
+      bytes.clear();
+    }
+  };
+
+  runs.merge([&](const BookRecord &record) {
+    if (!moves.empty() && record.key != key) {
+      flush();
+    }
+    key = record.key;
+    if (!moves.empty() && moves.back().first == record.move) {
+      moves.back().second += record.score;
+    } else {
+      moves.emplace_back(record.move, record.score);
+    }
+  });
+  flush();
+  writeBytes(stream, bytes);
+  stream.close();
+  if (!stream) {
+    throw GameException("Can't write " + book.string());
+  }
+  return entries;
+}
+} // namespace
+
+BookBuilderStats
+buildOpeningBook(const std::vector<std::filesystem::path> &inputs,
+                 const std::filesystem::path &book,
+                 const BookBuilderOptions &options) {
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<Input> opened;
+  // The first game of each input in a numbering of all the games
+  std::vector<std::size_t> first_game{0};
+  for (const std::filesystem::path &file : inputs) {
+    opened.push_back(openInput(file));
+    first_game.push_back(first_game.back() + opened.back().size());
+  }
+  const std::size_t game_count = first_game.back();
+
+  Runs runs{book.filename().string(), options.sort};
+  const auto add_game = [&](const std::size_t game,
+                            std::vector<BookRecord> &records) {
+    // The last input whose first game is not after this one
+    const std::size_t input =
+        static_cast<std::size_t>(std::ranges::upper_bound(first_game, game) -
+                                 first_game.begin()) -
+        1;
+    try {
+      return addRecords(readInputGame(opened[input], game - first_game[input]),
+                        options.maxPly, records);
+    } catch (const GameException &) {
+      return false;
+    }
+  };
+  const std::size_t failed = runs.fill(game_count, add_game);
+
+  const std::size_t entries = mergeRuns(runs, book);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return {.games = game_count,
+          .failed = failed,
+          .records = runs.records(),
+          .runs = runs.size(),
+          .entries = entries,
+          .seconds = elapsed.count()};
+}
+} // namespace chess
+
+#if defined(UNIT_TEST)
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("buildOpeningBook") {
+  const std::filesystem::path directory =
+      std::filesystem::temp_directory_path();
+  const std::filesystem::path pgn_file =
+      chess::uniqueTempPath(directory, "chess_book_games.pgn");
+  const std::filesystem::path archive_file =
+      chess::uniqueTempPath(directory, "chess_book_games.cga");
+  const std::filesystem::path book_file =
+      chess::uniqueTempPath(directory, "chess_book_built.bin");
+
+  // 1. e4 is played in a won, a lost, an unfinished and two archived games,
+  // 1. d4 in a draw
+  {
+    std::ofstream out{pgn_file, std::ios::binary};
+    out << "[Result \"1-0\"]\n\n1. e4 e5 2. Nf3 1-0\n\n"
+           "[Result \"0-1\"]\n\n1. e4 c5 0-1\n\n"
+           "[Result \"1/2-1/2\"]\n\n1. d4 d5 1/2-1/2\n\n"
+           "[Result \"*\"]\n\n1. e4 e5 2. Ke3 *\n";
+  }
+  const chess::Move e4{{1, 4}, {3, 4}};
+  const chess::Move e5{{6, 4}, {4, 4}};
+  {
+    chess::ArchiveWriter writer{archive_file};
+    writer.add("", std::array{e4, e5});
+    writer.add("", std::array{e4, e5});
+    writer.finish();
+  }
+
+  chess::BookBuilderOptions options{.maxPly = 2, .sort = {.threads = 2}};
+  // A few records per run
+  options.sort.memory = 64;
+  const chess::BookBuilderStats stats =
+      chess::buildOpeningBook({pgn_file, archive_file}, book_file, options);
+  CHECK(stats.games == 6);
+  // The game with an illegal move still counts up to it
+  CHECK(stats.failed == 1);
+  CHECK(stats.records == 12);
+  CHECK(stats.runs > 1);
+  // e4 and d4, then e5, c5 and d5
+  CHECK(stats.entries == 5);
+
+  const chess::OpeningBook book{book_file};
+  CHECK(book.size() == stats.entries);
+  chess::GameState state;
+  const std::vector<chess::BookMove> first = book.moves(state);
+  REQUIRE(first.size() == 2);
+  CHECK(first[0].move == e4);
+  // Won, lost, then unknown results
+  CHECK(first[0].weight == 2 + 0 + 1 + 1 + 1);
+  CHECK(chess::toString(first[1].move) == "D2-D4");
+  CHECK(first[1].weight == 1);
+
+  state.makeMove(e4);
+  const std::vector<chess::BookMove> replies = book.moves(state);
+  REQUIRE(replies.size() == 2);
+  CHECK(replies[0].move == e5);
+  CHECK(replies[0].weight == 0 + 1 + 1 + 1);
+  CHECK(chess::toString(replies[1].move) == "C7-C5");
+  CHECK(replies[1].weight == 2);
+
+  // Only the runs are temporary
+  CHECK(std::ranges::none_of(
+      std::filesystem::directory_iterator{directory},
+      [&book_file](const auto &entry) {
+        return entry.path().filename().string().starts_with(
+                   book_file.stem().string() + ".") &&
+               entry.path().extension() == ".run";
+      }));
+
+  // Inputs that can not be read are errors, not failed games
+  CHECK_THROWS_AS(
+      chess::buildOpeningBook({directory / "chess_book_missing.dat"},
+                              book_file),
+      chess::GameException);
+  CHECK_THROWS_AS(chess::buildOpeningBook({book_file}, book_file),
+                  chess::GameException);
+
+  std::filesystem::remove(pgn_file);
+  std::filesystem::remove(archive_file);
+  std::filesystem::remove(book_file);
+}
+
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "sorted_runs.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace chess {
+struct BookBuilderOptions {
+  /// Only the first moves of each game go into the book
+  std::uint32_t maxPly = 24;
+  /// The threads that replay the games and the memory they sort in
+  SortedRunsOptions sort;
+};
+
+struct BookBuilderStats {
+  std::size_t games = 0;
+  /// Games that could not be read to the end; their moves before the
+  /// problem are kept
+  std::size_t failed = 0;
+  /// (position, move) records, one for each move played
+  std::size_t records = 0;
+  /// Sorted runs written before the merge
+  std::size_t runs = 0;
+  /// Entries in the book, one for each distinct move of a position
+  std::size_t entries = 0;
+  double seconds = 0.0;
+};
+
+/// @brief Builds a Polyglot opening book, see OpeningBook, from the games
+///  of @a inputs: text games (.dat), game archives and PGN files.
+///
+/// The games are replayed on options.sort.threads threads. Each move up to
+/// options.maxPly becomes a (polyglotKey(), move, score) record, the score
+/// being 2 for a move of the side that won, 1 for a draw or an unknown
+/// result and 0 for the side that lost. The records are sorted through
+/// SortedRuns, so the games may hold more records than fit in memory. The
+/// scores of a move are added up into its weight, scaled down to 16 bits
+/// within a position if needed.
+/// @throws GameException if an input can not be opened or is not a text game,
+///  archive or PGN file, or if a file can not be written.
+BookBuilderStats
+buildOpeningBook(const std::vector<std::filesystem::path> &inputs,
+                 const std::filesystem::path &book,
+                 const BookBuilderOptions &options = {});
+} // namespace chess
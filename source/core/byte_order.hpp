@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <span>
+#include <vector>
+
+namespace chess {
+/// @return The unsigned integer stored little endian at @a offset of
+///  @a bytes, the byte order of the files written by this program.
+template <typename T>
+[[nodiscard]] T readLittleEndian(const std::span<const std::byte> bytes,
+                                 const std::size_t offset) {
+  T value = 0;
+  for (std::size_t i = 0; i < sizeof(T); i++) {
+    value |= std::to_integer<T>(bytes[offset + i]) << (8 * i);
+  }
+  return value;
+}
+
+template <typename T>
+void appendLittleEndian(std::vector<std::byte> &bytes, const T value) {
+  for (std::size_t i = 0; i < sizeof(T); i++) {
+    bytes.push_back(static_cast<std::byte>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+/// @return The unsigned integer stored big endian at @a offset of @a bytes,
+///  the byte order of Polyglot opening books.
+template <typename T>
+[[nodiscard]] T readBigEndian(const std::span<const std::byte> bytes,
+                              const std::size_t offset) {
+  T value = 0;
+  for (std::size_t i = 0; i < sizeof(T); i++) {
+    value = static_cast<T>(value << 8) | std::to_integer<T>(bytes[offset + i]);
+  }
+  return value;
+}
+
+template <typename T>
+void appendBigEndian(std::vector<std::byte> &bytes, const T value) {
+  for (std::size_t i = sizeof(T); i-- > 0;) {
+    bytes.push_back(static_cast<std::byte>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+/// Writes @a bytes as they are, e.g. the records built with the functions
+/// above. Failures are left in the state of @a stream.
+inline void writeBytes(std::ostream &stream,
+                       const std::span<const std::byte> bytes) {
+  stream.write(reinterpret_cast<const char *>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+}
+} // namespace chess
@@ -0,0 +1,112 @@
+#include "check_info.hpp"
+#include "attacks.hpp"
+
+namespace chess {
+
+CheckInfo::CheckInfo(const Board &board, const Side side)
+    : mKingSquare(board.kingSquare(side)) {
+  if (!mKingSquare) {
+    return;
+  }
+  const int king = *mKingSquare;
+  const Side opponent = opponentSide(side);
+  const Bitboard occupied = board.occupied();
+  const Bitboard queens = board.pieces(Piece::kQueen, opponent);
+
+  mCheckers = (pawnAttacks(side, king) & board.pieces(Piece::kPawn, opponent)) |
+              (knightAttacks(king) & board.pieces(Piece::kKnight, opponent));
+
+  // Sliders that would attack the king on an empty board either check it,
+  // pin the only piece in between, or are blocked
+  const Bitboard snipers =
+      (rookAttacks(king, kEmptyBitboard) &
+       (board.pieces(Piece::kRook, opponent) | queens)) |
+      (bishopAttacks(king, kEmptyBitboard) &
+       (board.pieces(Piece::kBishop, opponent) | queens));
+  for (const int sniper : BitboardSquares{snipers}) {
+    const Bitboard blockers = squaresBetween(king, sniper) & occupied;
+    if (blockers == kEmptyBitboard) {
+      mCheckers |= squareBit(sniper);
+    } else if (popCount(blockers) == 1 && (blockers & board.pieces(side))) {
+      mPinned |= blockers;
+    }
+  }
+
+  if (popCount(mCheckers) > 1) {
+    mCheckMask = kEmptyBitboard;
+  } else if (mCheckers != kEmptyBitboard) {
+    mCheckMask = mCheckers | squaresBetween(king, lsb(mCheckers));
+  }
+}
+
+Bitboard CheckInfo::checkers() const { return mCheckers; }
+
+Bitboard CheckInfo::pinned() const { return mPinned; }
+
+Bitboard CheckInfo::pinRay(const int square) const {
+  return testSquare(mPinned, square) ? lineThrough(*mKingSquare, square)
+                                     : ~kEmptyBitboard;
+}
+
+Bitboard CheckInfo::checkMask() const { return mCheckMask; }
+
+std::optional<int> CheckInfo::kingSquare() const { return mKingSquare; }
+
+} // namespace chess
+
+#if defined(UNIT_TEST)
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("CheckInfo initial board") {
+  const chess::Board board;
+  const chess::CheckInfo info{board, chess::Side::kWhite};
+  CHECK(info.checkers() == chess::kEmptyBitboard);
+  CHECK(info.pinned() == chess::kEmptyBitboard);
+  CHECK(info.checkMask() == ~chess::kEmptyBitboard);
+  CHECK(info.kingSquare() == 4);
+}
+
+TEST_CASE("CheckInfo pins and checks") {
+  using namespace chess::pieces;
+  // clang-format off
+  constexpr chess::Board::BoardArray position{
+    E, E, E, E, K, E, E, E,
+    R, E, E, E, B, E, E, E,
+    E, E, N, E, E, E, E, E,
+    E, b, E, E, E, E, E, E,
+    E, E, E, E, E, E, E, E,
+    E, E, E, E, q, E, E, E,
+    E, E, E, E, E, E, E, E,
+    E, E, E, E, k, E, E, r};
+  // clang-format on
+  const chess::Board board{position};
+
+  SECTION("Pinned pieces") {
+    const chess::CheckInfo info{board, chess::Side::kWhite};
+    // The bishop on E2 is pinned by the queen and the knight on C3 by the
+    // bishop; the rook on A2 is free
+    CHECK(info.checkers() == chess::kEmptyBitboard);
+    CHECK(info.pinned() == (chess::squareBit(12) | chess::squareBit(18)));
+    CHECK(info.pinRay(12) == 0x1010101010101010ULL);
+    CHECK(info.pinRay(18) == 0x0000000102040810ULL);
+    CHECK(info.pinRay(8) == ~chess::kEmptyBitboard);
+  }
+  SECTION("Single check") {
+    chess::Board checked = board;
+    checked.setSquare(chess::Position{1, 4}, E);
+    const chess::CheckInfo info{checked, chess::Side::kWhite};
+    CHECK(info.checkers() == chess::squareBit(44));
+    CHECK(info.checkMask() == 0x0000101010101000ULL);
+  }
+  SECTION("Double check") {
+    chess::Board checked = board;
+    checked.setSquare(chess::Position{1, 4}, E);
+    checked.setSquare(chess::Position{2, 2}, E);
+    const chess::CheckInfo info{checked, chess::Side::kWhite};
+    CHECK(chess::popCount(info.checkers()) == 2);
+    CHECK(info.checkMask() == chess::kEmptyBitboard);
+  }
+}
+
+#endif
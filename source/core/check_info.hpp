@@ -0,0 +1,42 @@
+#pragma once
+
+#include "board.hpp"
+
+namespace chess {
+/// @brief The pieces checking the king of one side and the pieces pinned to
+///  it, found once per position.
+///
+/// With it, a move other than a king move or an en passant capture is legal
+/// exactly when its destination is in checkMask() and in pinRay() of its
+/// origin, so no attack test is needed for it.
+class CheckInfo {
+public:
+  CheckInfo() = default;
+  CheckInfo(const Board &board, Side side);
+
+  /// @return The opponent pieces attacking the king.
+  [[nodiscard]] Bitboard checkers() const;
+
+  /// @return The pieces of the side that are pinned to their king.
+  [[nodiscard]] Bitboard pinned() const;
+
+  /// @return The squares a piece on @a square can move to without exposing
+  ///  the king: the line through the king if the piece is pinned, otherwise
+  ///  every square.
+  [[nodiscard]] Bitboard pinRay(int square) const;
+
+  /// @return The squares a move other than a king move must land on: every
+  ///  square if the king is not in check, the checker and the squares in
+  ///  between for a single check, none for a double check.
+  [[nodiscard]] Bitboard checkMask() const;
+
+  /// @return The king square, if the side has a king.
+  [[nodiscard]] std::optional<int> kingSquare() const;
+
+private:
+  std::optional<int> mKingSquare;
+  Bitboard mCheckers = kEmptyBitboard;
+  Bitboard mPinned = kEmptyBitboard;
+  Bitboard mCheckMask = ~kEmptyBitboard;
+};
+} // namespace chess
@@ -2,6 +2,7 @@
 #include "board.hpp"
 
 #include <array>
+#include <cstdint>
 
 namespace chess {
 Side getPieceSide(PieceWithSide piece);
@@ -14,6 +15,29 @@ std::string describePiece(PieceWithSide piece);
 
 enum struct BoardSide { QUEEN_SIDE = 2, KING_SIDE = 3 };
 
+/// Which castlings are still allowed, one bit per side and board side
+using CastlingRights = std::uint8_t;
+
+constexpr CastlingRights kNoCastlingRights = 0;
+constexpr CastlingRights kAllCastlingRights = 0xF;
+
+/// @return The bit of the right of @a side to castle on @a board_side.
+[[nodiscard]] constexpr CastlingRights
+castlingRight(const Side side, const BoardSide board_side) {
+  return static_cast<CastlingRights>(
+      1 << (static_cast<int>(side) * 2 +
+            (board_side == BoardSide::KING_SIDE ? 0 : 1)));
+}
+
+/// Whether the side to move can still play, see Game::status()
+enum struct GameStatus {
+  kOngoing,
+  kCheckmate,
+  kStalemate,
+  kThreefoldRepetition,
+  kFiftyMoveRule
+};
+
 enum struct Direction { HORIZONTAL = 0, VERTICAL, DIAGONAL, L_SHAPE };
 
 struct EnPassant {
@@ -1,18 +1,15 @@
 #include "game.hpp"
+#include "attacks.hpp"
 #include "logic.hpp"
+#include "movegen.hpp"
 #include "user_interface.hpp"
 
 #include <algorithm>
 #include <cassert>
-#include <iostream>
 #include <ranges>
 
 namespace chess {
 namespace {
-constexpr std::array<Position, 8> knight_moves = {
-    Position{1, -2},  Position{2, -1},  Position{2, 1},  Position{1, 2},
-    Position{-1, -2}, Position{-2, -1}, Position{-2, 1}, Position{-1, 2}};
-
 bool isValidPosition(const Position pos) {
   return pos.iColumn >= 0 && pos.iColumn < kNumCols && pos.iRow >= 0 &&
          pos.iRow < kNumRows;
@@ -32,833 +29,222 @@ std::pair<Position, Position> parseMove(const std::string &move) {
   return {from, to};
 }
 
-void Game::movePiece(Position present, Position future, EnPassant &S_enPassant,
-                     Castling &S_castling, Promotion &S_promotion) {
-  // Get the piece to be moved
-  const SquareState piece = getPieceAtPosition(present);
-  assert(piece);
-
-  // Is the destination square occupied?
-  const SquareState chCapturedPiece = getPieceAtPosition(future);
-
-  // So, was a piece captured in this move?
-  if (chCapturedPiece) {
-    capturePiece(*chCapturedPiece);
-    // Set Undo structure. If a piece was captured, then no "en passant" move
-    // performed
-    m_undo.bCapturedLastMove = true;
-    m_undo.en_passant = std::nullopt;
-  } else if (S_enPassant.bApplied) {
-    const SquareState chCapturedEP =
-        getPieceAtPosition(S_enPassant.PawnCaptured);
-    capturePiece(*chCapturedEP);
-
-    // Now, remove the captured pawn
-    m_board(S_enPassant.PawnCaptured.iRow, S_enPassant.PawnCaptured.iColumn) =
-        pieces::E;
-
-    // Set Undo structure as piece was captured and "en passant" move was
-    // performed
-    m_undo.bCapturedLastMove = true;
-    m_undo.en_passant = S_enPassant;
-  } else {
-    m_undo.bCapturedLastMove = false;
-    m_undo.en_passant = std::nullopt;
-  }
-
-  // Remove piece from present position
-  m_board(present.iRow, present.iColumn) = pieces::E;
-
-  // Move piece to new position
-  if (S_promotion.bApplied) {
-    m_board(future.iRow, future.iColumn) = S_promotion.chAfter;
-    // Set Undo structure as a promotion occured
-    m_undo.promotion = S_promotion;
-  } else {
-    m_board(future.iRow, future.iColumn) = piece;
-    // Reset m_undo.promotion
-    m_undo.promotion = std::nullopt;
-  }
-
-  // Was it a castling move?
-  if (S_castling.bApplied) {
-    // The king was already move, but we still have to move the rook to 'jump'
-    // the king
-    const SquareState piece = getPieceAtPosition(S_castling.rook_before);
-
-    // Remove the rook from present position
-    m_board(S_castling.rook_before) = pieces::E;
+Game::Game(const GameState &state) : m_initialState(state) {}
 
-    // 'Jump' into to new position
-    m_board(S_castling.rook_after) = piece;
+Game Game::fromFen(const std::string_view fen) {
+  return Game{GameState::fromFen(fen)};
+}
 
-    // Write this information to the m_undo struct
-    m_undo.castling = S_castling;
+std::string Game::toFen() const { return m_state.toFen(); }
 
-    // Save the 'CastlingAllowed' information in case the move is undone
-    m_undo.bCastlingKingSideAllowed =
-        m_bCastlingKingSideAllowed[getCurrentTurn()];
-    m_undo.bCastlingQueenSideAllowed =
-        m_bCastlingQueenSideAllowed[getCurrentTurn()];
-  } else {
-    // Reset m_undo.castling
-    m_undo.castling = std::nullopt;
+void Game::movePiece(Position present, Position future, EnPassant &S_enPassant,
+                     Castling &S_castling, Promotion &S_promotion) {
+  Move move{present, future};
+  if (S_enPassant.bApplied) {
+    move = Move{present, future, MoveFlag::kEnPassant};
+  } else if (S_castling.bApplied) {
+    move = Move{present, future, MoveFlag::kCastling};
+  } else if (S_promotion.bApplied) {
+    move = Move{present, future, MoveFlag::kPromotion,
+                S_promotion.chAfter.mPiece};
   }
+  playMove(move);
+}
 
-  // Castling requirements
-  if (piece->mPiece == Piece::kKing) {
-    // After the king has moved once, no more castling allowed
-    m_bCastlingKingSideAllowed[getCurrentTurn()] = false;
-    m_bCastlingQueenSideAllowed[getCurrentTurn()] = false;
-  } else if (piece->mPiece == Piece::kRook) {
-    // If the rook moved from column 'A', no more castling allowed on the queen
-    // side
-    if (0 == present.iColumn) {
-      m_bCastlingQueenSideAllowed[getCurrentTurn()] = false;
-    }
+void Game::playMove(const Move move) {
+  logMove(move);
+  makeMove(move);
+}
 
-    // If the rook moved from column 'A', no more castling allowed on the queen
-    // side
-    else if (7 == present.iColumn) {
-      m_bCastlingKingSideAllowed[getCurrentTurn()] = false;
-    }
+void Game::makeMove(const Move move) {
+  m_positionKeys.push_back(hash());
+
+  // Save the state that the move may change, in case it is undone
+  UndoRecord &undo = m_undoStack.emplace_back(UndoRecord{
+      .state = m_state.makeMove(move), .check_info = m_checkInfo});
+  if (undo.state.captured) {
+    capturePiece(*undo.state.captured);
   }
 
-  // Change turns
-  changeTurns();
+  // Only the attacks crossing the changed squares need to be recomputed
+  undo.attacks = m_attacks.update(board(), undo.state.changed);
+  m_checkInfo = CheckInfo{board(), getCurrentTurn()};
 
-  // This move can be undone
-  m_undo.bCanUndo = true;
+  assert(m_attacks == AttackMap{board()});
 }
 
-void Game::undoLastMove() {
-  const std::string last_move = getLastMove();
-
-  // Parse the line
-  const auto [from, to] = parseMove(last_move);
-
-  // Since we want to undo a move, we will be moving the piece from (iToRow,
-  // iToColumn) to (iFromRow, iFromColumn)
-  const SquareState piece = getPieceAtPosition(to);
+void Game::unmakeMove() {
+  assert(!m_undoStack.empty());
+  const UndoRecord &undo = m_undoStack.back();
 
-  // Moving it back
-  // If there was a castling
-  if (m_undo.promotion && m_undo.promotion->bApplied) {
-    m_board(from.iRow, from.iColumn) = m_undo.promotion->chBefore;
-  } else {
-    m_board(from.iRow, from.iColumn) = piece;
+  m_state.unmakeMove(undo.state);
+  if (undo.state.captured) {
+    std::vector<PieceWithSide> &captured =
+        Side::kWhite == getPieceSide(*undo.state.captured) ? white_captured
+                                                           : black_captured;
+    captured.pop_back();
   }
 
-  // Change turns
-  changeTurns();
-
-  // If a piece was captured, move it back to the board
-  if (m_undo.bCapturedLastMove) {
-    // Let's retrieve the last captured piece
-    PieceWithSide chCaptured;
-    // Since we already changed turns back, it means we should we pop a piece
-    // from the oponents vector
-    if (Side::kWhite == m_CurrentTurn) {
-      chCaptured = black_captured.back();
-      black_captured.pop_back();
-    } else {
-      chCaptured = white_captured.back();
-      white_captured.pop_back();
-    }
+  // The board is back to where it was, and so are the attacks
+  m_attacks.restore(undo.attacks);
+  m_checkInfo = undo.check_info;
 
-    // Move the captured piece back. Was this an "en passant" move?
-    if (m_undo.en_passant && m_undo.en_passant->bApplied) {
-      // Move the captured piece back
-      m_board(m_undo.en_passant->PawnCaptured.iRow,
-              m_undo.en_passant->PawnCaptured.iColumn) = chCaptured;
-      // Remove the attacker
-      m_board(to.iRow, to.iColumn) = pieces::E;
-    } else {
-      m_board(to.iRow, to.iColumn) = chCaptured;
-    }
-  } else {
-    m_board(to.iRow, to.iColumn) = pieces::E;
-  }
+  m_undoStack.pop_back();
+  m_positionKeys.pop_back();
 
-  // If there was a castling
-  if (m_undo.castling && m_undo.castling->bApplied) {
-    const SquareState chRook = getPieceAtPosition(m_undo.castling->rook_after);
-    // Remove the rook from present position
-    m_board(m_undo.castling->rook_after) = pieces::E;
-    // 'Jump' into to new position
-    m_board(m_undo.castling->rook_before) = chRook;
-    // Restore the values of castling allowed or not
-    m_bCastlingKingSideAllowed[getCurrentTurn()] =
-        m_undo.bCastlingKingSideAllowed;
-    m_bCastlingQueenSideAllowed[getCurrentTurn()] =
-        m_undo.bCastlingQueenSideAllowed;
-  }
-
-  // Clean m_undo struct
-  m_undo.bCanUndo = false;
-  m_undo.bCapturedLastMove = false;
-  m_undo.en_passant = std::nullopt;
-  m_undo.castling = std::nullopt;
-  m_undo.promotion = std::nullopt;
+  assert(m_attacks == AttackMap{board()});
+}
 
-  // If it was a checkmate, toggle back to game not finished
-  m_bGameFinished = false;
+void Game::undoLastMove() {
+  unmakeMove();
 
   // Finally, remove the last move from the list
   deleteLastMove();
 }
 
-bool Game::undoIsPossible() const { return m_undo.bCanUndo; }
+bool Game::undoIsPossible() const { return !m_undoStack.empty(); }
 
 bool Game::castlingAllowed(const BoardSide iSide, const Side side) const {
-  if (BoardSide::QUEEN_SIDE == iSide) {
-    return m_bCastlingQueenSideAllowed.at(side);
-  } else // if ( KING_SIDE == iSide )
-  {
-    return m_bCastlingKingSideAllowed.at(side);
-  }
+  return m_state.castlingAllowed(iSide, side);
+}
+
+CastlingRights Game::castlingRights() const {
+  return m_state.castlingRights();
 }
 
 SquareState Game::getPieceAtPosition(const Position pos) const {
-  return m_board(pos.iRow, pos.iColumn);
+  return board()(pos.iRow, pos.iColumn);
 }
 
 SquareState Game::getPieceConsiderMove(
     const Position pos,
     const std::optional<IntendedMove> &intended_move) const {
-  return m_board.getPieceConsiderMove(pos, intended_move);
+  return board().getPieceConsiderMove(pos, intended_move);
 }
 
 UnderAttack
 Game::isUnderAttack(const Position pos, const Side side,
                     const std::optional<IntendedMove> &intended_move) const {
-  return underAttack(pos, side, m_board, intended_move);
+  return underAttack(pos, side, board(), intended_move);
 }
 
 bool Game::isReachable(const Position pos, const Side side) const {
-  bool bReachable = false;
-
-  // a) Direction: HORIZONTAL
-  // Check all the way to the right
-  for (int i = pos.iColumn + 1; i < 8; i++) {
-    if (const SquareState chPieceFound = getPieceAtPosition({pos.iRow, i})) {
-      if (side == getPieceSide(*chPieceFound)) {
-        // This is a piece of the same color
-        break;
-      } else if ((chPieceFound->mPiece == Piece::kQueen) ||
-                 (chPieceFound->mPiece == Piece::kRook)) {
-        // There is a queen or a rook to the right, so the square is reachable
-        bReachable = true;
-        break;
-      } else {
-        // There is a piece that does not move horizontally
-        break;
-      }
-    }
-  }
-
-  // Check all the way to the left
-  for (int i = pos.iColumn - 1; i >= 0; i--) {
-    if (const SquareState chPieceFound = getPieceAtPosition({pos.iRow, i})) {
-      if (side == getPieceSide(*chPieceFound)) {
-        // This is a piece of the same color
-        break;
-      } else if ((chPieceFound->mPiece == Piece::kQueen) ||
-                 (chPieceFound->mPiece == Piece::kRook)) {
-        // There is a queen or a rook to the left, so the square is reachable
-        bReachable = true;
-        break;
-      } else {
-        // There is a piece that does not move horizontally
-        break;
-      }
-    }
-  }
-
-  // b) Direction: VERTICAL
-  // Check all the way up
-  for (int i = pos.iRow + 1; i < 8; i++) {
-    if (const SquareState chPieceFound = getPieceAtPosition({pos.iRow, i})) {
-      if (side == getPieceSide(*chPieceFound)) {
-        // This is a piece of the same color
-        break;
-      } else if ((chPieceFound->mPiece == Piece::kPawn) &&
-                 (getPieceSide(*chPieceFound) == Side::kBlack) &&
-                 (i == pos.iRow + 1)) {
-        // There is a pawn one square up, so the square is reachable
-        bReachable = true;
-        break;
-      } else if ((chPieceFound->mPiece == Piece::kQueen) ||
-                 (chPieceFound->mPiece == Piece::kRook)) {
-        // There is a queen or a rook on the way up, so the square is reachable
-        bReachable = true;
-        break;
-      } else {
-        // There is a piece that does not move vertically
-        break;
-      }
-    }
-  }
+  return isReachable(pos, side, AttackMap{board()});
+}
 
-  // Check all the way down
-  for (int i = pos.iRow - 1; i >= 0; i--) {
-    if (const SquareState chPieceFound = getPieceAtPosition({pos.iRow, i})) {
-      if (side == getPieceSide(*chPieceFound)) {
-        // This is a piece of the same color
-        break;
-      } else if ((chPieceFound->mPiece == Piece::kPawn) &&
-                 (getPieceSide(*chPieceFound) == Side::kWhite) &&
-                 (i == pos.iRow - 1)) {
-        // There is a pawn one square down, so the square is reachable
-        bReachable = true;
-        break;
-      } else if ((chPieceFound->mPiece == Piece::kQueen) ||
-                 (chPieceFound->mPiece == Piece::kRook)) {
-        // There is a queen or a rook on the way down, so the square is
-        // reachable
-        bReachable = true;
-        break;
-      } else {
-        // There is a piece that does not move vertically
-        break;
-      }
-    }
+bool Game::isReachable(const Position pos, const Side side,
+                       const AttackMap &attacks) const {
+  const Side mover = opponentSide(side);
+  const int square = positionToSquare(pos);
+
+  // Pieces reach every square they attack; pawns only capture diagonally, so
+  // their attacks on an empty square do not count
+  const int pawnAttackers = popCount(pawnAttacks(side, square) &
+                                     board().pieces(Piece::kPawn, mover));
+  if (attacks.attackerCount(pos, mover) > pawnAttackers) {
+    return true;
   }
 
-  // c) Direction: DIAGONAL
-  {
-    // Check the diagonal up-right
-    for (int i = pos.iRow + 1, j = pos.iColumn + 1; i < 8 && j < 8; i++, j++) {
-      const SquareState chPieceFound = getPieceAtPosition({i, j});
-      if (!chPieceFound) {
-        // This square is empty, move on
-        continue;
-      }
-
-      if (side == getPieceSide(*chPieceFound)) {
-        // This is a piece of the same color
-        break;
-      } else if ((chPieceFound->mPiece == Piece::kQueen) ||
-                 (chPieceFound->mPiece == Piece::kBishop)) {
-        // There is a queen or a bishop in that direction, so the square is
-        // reachable
-        bReachable = true;
-        break;
-      } else {
-        // There is a piece that does not move diagonally
-        break;
-      }
-    }
-
-    // Check the diagonal up-left
-    for (int i = pos.iRow + 1, j = pos.iColumn - 1; i < 8 && j > 0; i++, j--) {
-      const SquareState chPieceFound = getPieceAtPosition({i, j});
-      if (!chPieceFound) {
-        // This square is empty, move on
-        continue;
-      }
-
-      if (side == getPieceSide(*chPieceFound)) {
-        // This is a piece of the same color
-        break;
-      } else if ((chPieceFound->mPiece == Piece::kQueen) ||
-                 (chPieceFound->mPiece == Piece::kBishop)) {
-        // There is a queen or a bishop in that direction, so the square is
-        // reachable
-        bReachable = true;
-        break;
-      } else {
-        // There is a piece that does not move diagonally
-        break;
-      }
-    }
-
-    // Check the diagonal down-right
-    for (int i = pos.iRow - 1, j = pos.iColumn + 1; i > 0 && j < 8; i--, j++) {
-      const SquareState chPieceFound = getPieceAtPosition({i, j});
-      if (!chPieceFound) {
-        // This square is empty, move on
-        continue;
-      }
-
-      if (side == getPieceSide(*chPieceFound)) {
-        // This is a piece of the same color
-        break;
-      } else if ((chPieceFound->mPiece == Piece::kQueen) ||
-                 (chPieceFound->mPiece == Piece::kBishop)) {
-        // There is a queen or a bishop in that direction, so the square is
-        // reachable
-        bReachable = true;
-        break;
-      } else {
-        // There is a piece that does not move diagonally
-        break;
-      }
-    }
-
-    // Check the diagonal down-left
-    for (int i = pos.iRow - 1, j = pos.iColumn - 1; i > 0 && j > 0; i--, j--) {
-      const SquareState chPieceFound = getPieceAtPosition({i, j});
-      if (!chPieceFound) {
-        // This square is empty, move on
-        continue;
-      }
-
-      if (side == getPieceSide(*chPieceFound)) {
-        // This is a piece of the same color
-        break;
-      } else if ((chPieceFound->mPiece == Piece::kQueen) ||
-                 (chPieceFound->mPiece == Piece::kBishop)) {
-        // There is a queen or a bishop in that direction, so the square is
-        // reachable
-        bReachable = true;
-        break;
-      } else {
-        // There is a piece that does not move diagonally
-        break;
-      }
-    }
+  // Pawns move straight ahead, by two squares from their initial row
+  const int forward = mover == Side::kWhite ? 1 : -1;
+  const int initialRow = mover == Side::kWhite ? 1 : 6;
+  const Position oneBehind{pos.iRow - forward, pos.iColumn};
+  if (!isValidPosition(oneBehind)) {
+    return false;
   }
-
-  // d) Direction: L_SHAPED
-  {
-    // Check if the piece is put in jeopardy by a knigh
-
-    for (int i = 0; i < 8; i++) {
-      const Position posToTest{pos.iRow + knight_moves[i].iRow,
-                               pos.iColumn + knight_moves[i].iColumn};
-
-      if (!isValidPosition(posToTest)) {
-        // This square does not even exist, so no need to test
-        continue;
-      }
-      const SquareState chPieceFound = getPieceAtPosition(posToTest);
-      if (!chPieceFound || side == getPieceSide(*chPieceFound)) {
-        // This square is empty
-        // or this is a piece of the same color
-        continue;
-      } else if (chPieceFound->mPiece == Piece::kKnight) {
-        bReachable = true;
-        break;
-      }
-    }
+  if (getPieceAtPosition(oneBehind) == PieceWithSide{Piece::kPawn, mover}) {
+    return true;
   }
-
-  return bReachable;
+  const Position twoBehind{pos.iRow - 2 * forward, pos.iColumn};
+  return twoBehind.iRow == initialRow && !isSquareOccupied(oneBehind) &&
+         getPieceAtPosition(twoBehind) == PieceWithSide{Piece::kPawn, mover};
 }
 
 bool Game::isSquareOccupied(const Position pos) const {
-  return getPieceAtPosition(pos).has_value();
+  return (board().occupied() & positionBit(pos)) != 0;
 }
 
 bool Game::isPathFree(const Position startingPos, const Position finishingPos,
                       const Direction iDirection) const {
-  bool bFree = false;
-
+  const int rows = finishingPos.iRow - startingPos.iRow;
+  const int columns = finishingPos.iColumn - startingPos.iColumn;
   switch (iDirection) {
-  case Direction::HORIZONTAL: {
-    // If it is a horizontal move, we can assume the startingPos.iRow ==
-    // finishingPos.iRow If the piece wants to move from column 0 to column 7,
-    // we must check if columns 1-6 are free
-    if (startingPos.iColumn == finishingPos.iColumn) {
-      std::cout << "Error. Movement is horizontal but column is the same\n";
-    }
-
-    // Moving to the right
-    else if (startingPos.iColumn < finishingPos.iColumn) {
-      // Settting bFree as initially true, only inside the cases, guarantees
-      // that the path is checked
-      bFree = true;
-
-      for (int i = startingPos.iColumn + 1; i < finishingPos.iColumn; i++) {
-        if (isSquareOccupied({startingPos.iRow, i})) {
-          bFree = false;
-          std::cout << "Horizontal path to the right is not clear!\n";
-        }
-      }
-    }
-
-    // Moving to the left
-    else // if (startingPos.iColumn > finishingPos.iColumn)
-    {
-      // Settting bFree as initially true, only inside the cases, guarantees
-      // that the path is checked
-      bFree = true;
-
-      for (int i = startingPos.iColumn - 1; i > finishingPos.iColumn; i--) {
-        if (isSquareOccupied({startingPos.iRow, i})) {
-          bFree = false;
-          std::cout << "Horizontal path to the left is not clear!\n";
-        }
-      }
-    }
-  } break;
-
-  case Direction::VERTICAL: {
-    // If it is a vertical move, we can assume the startingPos.iColumn ==
-    // finishingPos.iColumn If the piece wants to move from column 0 to column
-    // 7, we must check if columns 1-6 are free
-    if (startingPos.iRow == finishingPos.iRow) {
-      throw(GameException("Movement is vertical but row is the same"));
-    }
-
-    // Moving up
-    else if (startingPos.iRow < finishingPos.iRow) {
-      // Settting bFree as initially true, only inside the cases, guarantees
-      // that the path is checked
-      bFree = true;
-
-      for (int i = startingPos.iRow + 1; i < finishingPos.iRow; i++) {
-        if (isSquareOccupied({i, startingPos.iColumn})) {
-          bFree = false;
-          std::cout << "Vertical path up is not clear!\n";
-        }
-      }
-    }
-
-    // Moving down
-    else // if (startingPos.iColumn > finishingPos.iRow)
-    {
-      // Settting bFree as initially true, only inside the cases, guarantees
-      // that the path is checked
-      bFree = true;
-
-      for (int i = startingPos.iRow - 1; i > finishingPos.iRow; i--) {
-        if (isSquareOccupied({i, startingPos.iColumn})) {
-          bFree = false;
-          std::cout << "Vertical path down is not clear!\n";
-        }
-      }
-    }
-  } break;
-
-  case Direction::DIAGONAL: {
-    // Moving up and right
-    if ((finishingPos.iRow > startingPos.iRow) &&
-        (finishingPos.iColumn > startingPos.iColumn)) {
-      // Settting bFree as initially true, only inside the cases, guarantees
-      // that the path is checked
-      bFree = true;
-
-      for (int i = 1; i < abs(finishingPos.iRow - startingPos.iRow); i++) {
-        if (isSquareOccupied({startingPos.iRow + i, startingPos.iColumn + i})) {
-          bFree = false;
-          std::cout << "Diagonal path up-right is not clear!\n";
-        }
-      }
-    }
-
-    // Moving up and left
-    else if ((finishingPos.iRow > startingPos.iRow) &&
-             (finishingPos.iColumn < startingPos.iColumn)) {
-      // Settting bFree as initially true, only inside the cases, guarantees
-      // that the path is checked
-      bFree = true;
-
-      for (int i = 1; i < abs(finishingPos.iRow - startingPos.iRow); i++) {
-        if (isSquareOccupied({startingPos.iRow + i, startingPos.iColumn - i})) {
-          bFree = false;
-          std::cout << "Diagonal path up-left is not clear!\n";
-        }
-      }
-    }
-
-    // Moving down and right
-    else if ((finishingPos.iRow < startingPos.iRow) &&
-             (finishingPos.iColumn > startingPos.iColumn)) {
-      // Settting bFree as initially true, only inside the cases, guarantees
-      // that the path is checked
-      bFree = true;
-
-      for (int i = 1; i < abs(finishingPos.iRow - startingPos.iRow); i++) {
-        if (isSquareOccupied({startingPos.iRow - i, startingPos.iColumn + i})) {
-          bFree = false;
-          std::cout << "Diagonal path down-right is not clear!\n";
-        }
-      }
-    }
-
-    // Moving down and left
-    else if ((finishingPos.iRow < startingPos.iRow) &&
-             (finishingPos.iColumn < startingPos.iColumn)) {
-      // Settting bFree as initially true, only inside the cases, guarantees
-      // that the path is checked
-      bFree = true;
-
-      for (int i = 1; i < abs(finishingPos.iRow - startingPos.iRow); i++) {
-        if (isSquareOccupied({startingPos.iRow - i, startingPos.iColumn - i})) {
-          bFree = false;
-          std::cout << "Diagonal path down-left is not clear!\n";
-        }
-      }
-    } else {
-      throw(GameException("Diagonal move not allowed"));
-    }
-  } break;
-  }
-
-  return bFree;
-}
-
-bool Game::canBeBlocked(Position startingPos, Position finishingPos,
-                        const Direction iDirection) const {
-  bool bBlocked = false;
-
-  switch (iDirection) {
-  case Direction::HORIZONTAL: {
-    // If it is a horizontal move, we can assume the startingPos.iRow ==
-    // finishingPos.iRow If the piece wants to move from column 0 to column 7,
-    // we must check if columns 1-6 are free
-    if (startingPos.iColumn == finishingPos.iColumn) {
-      std::cout << "Error. Movement is horizontal but column is the same\n";
-    }
-
-    // Moving to the right
-    else if (startingPos.iColumn < finishingPos.iColumn) {
-      for (int i = startingPos.iColumn + 1; i < finishingPos.iColumn; i++) {
-        if (isReachable({startingPos.iRow, i}, getOpponentSide())) {
-          // Some piece can block the way
-          bBlocked = true;
-        }
-      }
-    }
-
-    // Moving to the left
-    else // if (startingPos.iColumn > finishingPos.iColumn)
-    {
-      for (int i = startingPos.iColumn - 1; i > finishingPos.iColumn; i--) {
-        if (isReachable({startingPos.iRow, i}, getOpponentSide())) {
-          // Some piece can block the way
-          bBlocked = true;
-        }
-      }
+  case Direction::HORIZONTAL:
+    if (rows != 0 || columns == 0) {
+      return false;
     }
-  } break;
-
-  case Direction::VERTICAL: {
-    // If it is a vertical move, we can assume the startingPos.iColumn ==
-    // finishingPos.iColumn If the piece wants to move from column 0 to column
-    // 7, we must check if columns 1-6 are free
-    if (startingPos.iRow == finishingPos.iRow) {
+    break;
+  case Direction::VERTICAL:
+    if (rows == 0) {
       throw(GameException("Movement is vertical but row is the same"));
     }
-
-    // Moving up
-    else if (startingPos.iRow < finishingPos.iRow) {
-      for (int i = startingPos.iRow + 1; i < finishingPos.iRow; i++) {
-        if (isReachable({i, startingPos.iColumn}, getOpponentSide())) {
-          // Some piece can block the way
-          bBlocked = true;
-        }
-      }
-    }
-
-    // Moving down
-    else // if (startingPos.iColumn > finishingPos.iRow)
-    {
-      for (int i = startingPos.iRow - 1; i > finishingPos.iRow; i--) {
-        if (isReachable({i, startingPos.iColumn}, getOpponentSide())) {
-          // Some piece can block the way
-          bBlocked = true;
-        }
-      }
-    }
-  } break;
-
-  case Direction::DIAGONAL: {
-    // Moving up and right
-    if ((finishingPos.iRow > startingPos.iRow) &&
-        (finishingPos.iColumn > startingPos.iColumn)) {
-      for (int i = 1; i < abs(finishingPos.iRow - startingPos.iRow); i++) {
-        if (isReachable({startingPos.iRow + i, startingPos.iColumn + i},
-                        getOpponentSide())) {
-          // Some piece can block the way
-          bBlocked = true;
-        }
-      }
-    }
-
-    // Moving up and left
-    else if ((finishingPos.iRow > startingPos.iRow) &&
-             (finishingPos.iColumn < startingPos.iColumn)) {
-      for (int i = 1; i < abs(finishingPos.iRow - startingPos.iRow); i++) {
-        if (isReachable({startingPos.iRow + i, startingPos.iColumn - i},
-                        getOpponentSide())) {
-          // Some piece can block the way
-          bBlocked = true;
-        }
-      }
-    }
-
-    // Moving down and right
-    else if ((finishingPos.iRow < startingPos.iRow) &&
-             (finishingPos.iColumn > startingPos.iColumn)) {
-      for (int i = 1; i < abs(finishingPos.iRow - startingPos.iRow); i++) {
-        if (isReachable({startingPos.iRow - i, startingPos.iColumn + i},
-                        getOpponentSide())) {
-          // Some piece can block the way
-          bBlocked = true;
-        }
-      }
-    }
-
-    // Moving down and left
-    else if ((finishingPos.iRow < startingPos.iRow) &&
-             (finishingPos.iColumn < startingPos.iColumn)) {
-      for (int i = 1; i < abs(finishingPos.iRow - startingPos.iRow); i++) {
-        if (isReachable({startingPos.iRow - i, startingPos.iColumn - i},
-                        getOpponentSide())) {
-          // Some piece can block the way
-          bBlocked = true;
-        }
-      }
-    } else {
+    break;
+  case Direction::DIAGONAL:
+    if (rows == 0 || abs(rows) != abs(columns)) {
       throw(GameException("Diagonal move not allowed"));
     }
-  } break;
+    break;
   }
 
-  return bBlocked;
+  return (squaresBetween(positionToSquare(startingPos),
+                         positionToSquare(finishingPos)) &
+          board().occupied()) == kEmptyBitboard;
 }
 
-bool Game::isCheckMate() {
-  bool bCheckmate = false;
-
-  // 1. First of all, is the king in check?
-  if (!playerKingInCheck()) {
-    return false;
+GameStatus Game::status() const {
+  // A checkmate on the hundredth halfmove still wins the game
+  if (!hasLegalMove(*this)) {
+    return m_checkInfo.checkers() != kEmptyBitboard ? GameStatus::kCheckmate
+                                                    : GameStatus::kStalemate;
   }
-
-  // 2. Can the king move to another square?
-  constexpr std::array<Position, 8> king_moves{
-      Position{1, -1}, Position{1, 0},  Position{1, 1},   Position{0, 1},
-      Position{-1, 1}, Position{-1, 0}, Position{-1, -1}, Position{0, -1}};
-
-  const Position king = findKing(m_board, getCurrentTurn());
-
-  for (int i = 0; i < 8; i++) {
-    const Position posToTest{king.iRow + king_moves[i].iRow,
-                             king.iColumn + king_moves[i].iColumn};
-
-    if (!isValidPosition(posToTest)) {
-      // This square does not even exist, so no need to test
-      continue;
-    }
-
-    if (const SquareState square = getPieceAtPosition(posToTest);
-        square->mSide == m_CurrentTurn) {
-      // That square is not empty, so no need to test
-      // TODO: what if it's an oponent piece?
-      continue;
-    }
-
-    const IntendedMove intended_move{.piece = getPieceAtPosition(king).value(),
-                                     .from = king,
-                                     .to = posToTest};
-
-    // Now, for every possible move of the king, check if it would be in
-    // jeopardy Since the move has already been made,
-    // current_game->getCurrentTurn() now will return the next player's color.
-    // And it is in fact this king that we want to check for
-    const UnderAttack king_moved =
-        isUnderAttack(posToTest, getCurrentTurn(), intended_move);
-
-    if (!king_moved.bUnderAttack) {
-      // This means there is at least one position when the king would not be in
-      // jeopardy, so that's not a checkmate
-      return false;
-    }
+  if (isFiftyMoveRule()) {
+    return GameStatus::kFiftyMoveRule;
   }
-
-  // 3. Can the attacker be taken or another piece get into the way?
-  const UnderAttack king_attacked = isUnderAttack(king, getCurrentTurn());
-  if (king_attacked.iNumAttackers == 1) {
-    // Can the attacker be taken?
-    const UnderAttack king_attacker =
-        isUnderAttack(king_attacked.attacker.front().pos, getOpponentSide());
-
-    if (king_attacker.bUnderAttack) {
-      // This means that the attacker can be taken, so it's not a checkmate
-      return false;
-    } else {
-      // Last resort: can any piece get in between the attacker and the king?
-      const SquareState chAttacker =
-          getPieceAtPosition(king_attacked.attacker.front().pos);
-
-      switch (chAttacker->mPiece) {
-      case Piece::kPawn:
-      case Piece::kKing: {
-        // If it's a pawn, there's no space in between the attacker and the king
-        // If it's a knight, it doesn't matter because the knight can 'jump'
-        // So, this is checkmate
-        bCheckmate = true;
-      } break;
-
-      case Piece::kBishop: {
-        if (!canBeBlocked(king_attacked.attacker[0].pos, king,
-                          Direction::DIAGONAL)) {
-          // If no piece can get in the way, it's a checkmate
-          bCheckmate = true;
-        }
-      } break;
-
-      case Piece::kRook: {
-        if (!canBeBlocked(king_attacked.attacker[0].pos, king,
-                          king_attacked.attacker[0].dir)) {
-          // If no piece can get in the way, it's a checkmate
-          bCheckmate = true;
-        }
-      } break;
-
-      case Piece::kQueen: {
-        if (!canBeBlocked(king_attacked.attacker[0].pos, king,
-                          king_attacked.attacker[0].dir)) {
-          // If no piece can get in the way, it's a checkmate
-          bCheckmate = true;
-        }
-      } break;
-
-      default: {
-        throw(GameException("Invalid piece"));
-      } break;
-      }
-    }
-  } else {
-    // If there is more than one attacker and we reached this point, it's a
-    // checkmate
-    bCheckmate = true;
+  if (isThreefoldRepetition()) {
+    return GameStatus::kThreefoldRepetition;
   }
-
-  // If the game has ended, store in the class variable
-  m_bGameFinished = bCheckmate;
-
-  return bCheckmate;
+  return GameStatus::kOngoing;
 }
 
+bool Game::isCheckMate() const { return status() == GameStatus::kCheckmate; }
+
 bool Game::playerKingInCheck(
     const std::optional<IntendedMove> &intended_move) const {
-  return isKingInCheck(m_board, getCurrentTurn(), intended_move);
+  if (!intended_move) {
+    return m_attacks.isAttacked(findKing(board(), getCurrentTurn()),
+                                getOpponentSide());
+  }
+  return isKingInCheck(board(), getCurrentTurn(), intended_move);
 }
 
 bool Game::wouldKingBeInCheck(const PieceWithSide piece, const Position present,
                               const Position future,
                               EnPassant &S_enPassant) const {
-  const IntendedMove intended_move{
-      .piece = piece, .from = present, .to = future};
-  return playerKingInCheck(intended_move);
-}
+  const int from = positionToSquare(present);
+  const int to = positionToSquare(future);
 
-void Game::changeTurns(void) {
-  if (Side::kWhite == m_CurrentTurn) {
-    m_CurrentTurn = Side::kBlack;
-  } else {
-    m_CurrentTurn = Side::kWhite;
+  if (piece.mPiece == Piece::kKing) {
+    // The king must not stay on the rays it is moving along
+    return isSquareAttacked(board(), to, getOpponentSide(),
+                            board().occupied() & ~squareBit(from));
+  }
+
+  if (S_enPassant.bApplied) {
+    // Two pawns leave the row of the king at once, which no pin accounts for.
+    // The captured pawn is not on the destination square, take it off first
+    const IntendedMove intended_move{
+        .piece = piece, .from = present, .to = future};
+    Board without_captured = board();
+    without_captured.setSquare(S_enPassant.PawnCaptured, pieces::E);
+    return isKingInCheck(without_captured, getCurrentTurn(), intended_move);
   }
+
+  return !testSquare(m_checkInfo.checkMask() & m_checkInfo.pinRay(from), to);
 }
 
-bool Game::isFinished() const { return m_bGameFinished; }
+bool Game::isFinished() const { return status() != GameStatus::kOngoing; }
 
-Side Game::getCurrentTurn() const { return m_CurrentTurn; }
+Side Game::getCurrentTurn() const { return m_state.sideToMove(); }
 
 Side Game::getOpponentSide() const { return opponentSide(getCurrentTurn()); }
 
@@ -870,45 +256,27 @@ Game::parseMoveWithPromotion(const std::string &move) const {
   return {from, to, chPromoted};
 }
 
-void Game::logMove(std::string &to_record) {
-  // If record contains only 5 chracters, add spaces
-  // Because when
-  if (to_record.length() == 5) {
-    to_record += "  ";
-  }
-
+void Game::logMove(const Move move) {
   if (Side::kWhite == getCurrentTurn()) {
     // If this was a white player move, create a new round and leave the
     // black_move empty
-    Round round;
-    round.white_move = to_record;
-    round.black_move = "";
-
-    rounds.push_back(round);
+    rounds.push_back(Round{.white_move = move});
+  } else if (rounds.empty()) {
+    // The game was set up with black to move
+    rounds.push_back(Round{.black_move = move});
   } else {
     // If this was a black_move, just update the last Round
-    Round round = rounds[rounds.size() - 1];
-    round.black_move = to_record;
-
-    // Remove the last round and put it back, now with the black move
-    rounds.pop_back();
-    rounds.push_back(round);
+    rounds.back().black_move = move;
   }
 }
 
-std::string Game::getLastMove() const {
-  std::string last_move;
-
-  // Who did the last move?
-  if (Side::kBlack == getCurrentTurn()) {
-    // If it's black's turn now, white had the last move
-    last_move = rounds[rounds.size() - 1].white_move;
-  } else {
-    // Last move was black's
-    last_move = rounds[rounds.size() - 1].black_move;
+std::optional<Move> Game::getLastMove() const {
+  if (rounds.empty()) {
+    return std::nullopt;
   }
-
-  return last_move;
+  // If it's black's turn now, white had the last move
+  return Side::kBlack == getCurrentTurn() ? rounds.back().white_move
+                                          : rounds.back().black_move;
 }
 
 void Game::deleteLastMove(void) {
@@ -917,13 +285,11 @@ void Game::deleteLastMove(void) {
     // Last move was white's turn, so simply pop from the back
     rounds.pop_back();
   } else {
-    // Last move was black's, so let's
-    Round round = rounds[rounds.size() - 1];
-    round.black_move = "";
-
-    // Pop last round and put it back, now without the black move
-    rounds.pop_back();
-    rounds.push_back(round);
+    // Last move was black's
+    rounds.back().black_move = std::nullopt;
+    if (!rounds.back().white_move) {
+      rounds.pop_back();
+    }
   }
 }
 
@@ -937,7 +303,43 @@ void Game::capturePiece(const PieceWithSide piece) {
   }
 }
 
-const Board &Game::board() const { return m_board; }
+const Board &Game::board() const { return m_state.board(); }
+
+const GameState &Game::state() const { return m_state; }
+
+const GameState &Game::initialState() const { return m_initialState; }
+
+const AttackMap &Game::attacks() const { return m_attacks; }
+
+const CheckInfo &Game::checkInfo() const { return m_checkInfo; }
+
+std::uint64_t Game::hash() const { return m_state.hash(); }
+
+std::uint64_t Game::computeHash() const { return m_state.computeHash(); }
+
+std::optional<int> Game::enPassantSquare() const {
+  return m_state.enPassantSquare();
+}
+
+int Game::halfmoveClock() const { return m_state.halfmoveClock(); }
+
+bool Game::isThreefoldRepetition() const {
+  // A capture or a pawn move can not be taken back, so no position before the
+  // last one repeats; and only every other position has the same side to move
+  const int reversible = std::min(
+      halfmoveClock(), static_cast<int>(m_positionKeys.size()));
+  const std::uint64_t key = hash();
+  int occurrences = 1;
+  for (int back = 2; back <= reversible; back += 2) {
+    if (m_positionKeys[m_positionKeys.size() - back] == key &&
+        ++occurrences == 3) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Game::isFiftyMoveRule() const { return halfmoveClock() >= 100; }
 
 void makeTheMove(chess::Game &current_game, const chess::Position present,
                  const chess::Position future, chess::EnPassant &S_enPassant,
@@ -969,6 +371,10 @@ void makeTheMove(chess::Game &current_game, const chess::Position present,
 
 #if defined(UNIT_TEST)
 
+#include "movegen.hpp"
+#include "test_utility.hpp"
+#include "validation.hpp"
+
 #include <catch2/catch_test_macros.hpp>
 
 TEST_CASE("Parse move charToRow") {
@@ -1054,4 +460,324 @@ TEST_CASE("Game isUnderAttack_initialBoard") {
   }
 }
 
+TEST_CASE("Game isReachable_initialBoard") {
+  const chess::Game game;
+  // The side passed in is the one whose pieces are not considered
+  CHECK(game.isReachable(chess::Position{2, 0}, chess::Side::kBlack));
+  CHECK(game.isReachable(chess::Position{3, 4}, chess::Side::kBlack));
+  CHECK(!game.isReachable(chess::Position{4, 4}, chess::Side::kBlack));
+  CHECK(game.isReachable(chess::Position{4, 3}, chess::Side::kWhite));
+  CHECK(!game.isReachable(chess::Position{3, 3}, chess::Side::kWhite));
+  // Pawns attack f3 but cannot move there, only the knight on g1 can
+  CHECK(game.isReachable(chess::Position{2, 5}, chess::Side::kBlack));
+  CHECK(!game.isReachable(chess::Position{2, 5}, chess::Side::kWhite));
+
+  const chess::AttackMap attacks{game.board()};
+  CHECK(game.isReachable(chess::Position{2, 7}, chess::Side::kBlack, attacks));
+  CHECK(!game.isReachable(chess::Position{5, 7}, chess::Side::kBlack, attacks));
+}
+
+TEST_CASE("Game rounds") {
+  chess::Game game;
+  CHECK(!game.getLastMove());
+  chess::test::playTestMove(game, "E2-E4");
+  chess::test::playTestMove(game, "E7-E5");
+  REQUIRE(game.rounds.size() == 1);
+  REQUIRE(game.rounds[0].white_move);
+  CHECK(chess::toString(*game.rounds[0].white_move) == "E2-E4");
+  REQUIRE(game.rounds[0].black_move);
+  CHECK(chess::toString(*game.rounds[0].black_move) == "E7-E5");
+  CHECK(game.getLastMove() == game.rounds[0].black_move);
+
+  game.undoLastMove();
+  CHECK(!game.rounds[0].black_move);
+  CHECK(game.getLastMove() == game.rounds[0].white_move);
+  game.undoLastMove();
+  CHECK(game.rounds.empty());
+}
+
+TEST_CASE("Game from FEN") {
+  constexpr std::string_view fen =
+      "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1";
+  chess::Game game = chess::Game::fromFen(fen);
+  CHECK(game.toFen() == fen);
+  CHECK(game.getCurrentTurn() == chess::Side::kBlack);
+  CHECK(game.checkInfo().kingSquare() == 60);
+
+  // The first round has no white move
+  chess::test::playTestMove(game, "E7-E5");
+  REQUIRE(game.rounds.size() == 1);
+  CHECK(!game.rounds[0].white_move);
+  CHECK(game.getLastMove() == game.rounds[0].black_move);
+  chess::test::playTestMove(game, "G1-F3");
+  CHECK(game.rounds.size() == 2);
+
+  game.undoLastMove();
+  game.undoLastMove();
+  CHECK(game.rounds.empty());
+  CHECK(game.toFen() == fen);
+  CHECK(game.initialState().toFen() == fen);
+}
+
+TEST_CASE("Game hash") {
+  chess::Game game;
+  const std::uint64_t initial = game.hash();
+  CHECK(initial == game.computeHash());
+
+  SECTION("Move and undo") {
+    chess::test::playTestMove(game, "E2-E4");
+    CHECK(game.hash() != initial);
+    CHECK(game.hash() == game.computeHash());
+    game.undoLastMove();
+    CHECK(game.hash() == initial);
+  }
+  SECTION("Transposition") {
+    chess::test::playTestMove(game, "G1-F3");
+    chess::test::playTestMove(game, "G8-F6");
+    chess::test::playTestMove(game, "F3-G1");
+    chess::test::playTestMove(game, "F6-G8");
+    CHECK(game.hash() == initial);
+  }
+  SECTION("Castling rights") {
+    chess::test::playTestMove(game, "E2-E4");
+    chess::test::playTestMove(game, "E7-E5");
+    const std::uint64_t before = game.hash();
+    chess::test::playTestMove(game, "E1-E2");
+    chess::test::playTestMove(game, "E8-E7");
+    chess::test::playTestMove(game, "E2-E1");
+    chess::test::playTestMove(game, "E7-E8");
+    CHECK(!game.castlingAllowed(chess::BoardSide::KING_SIDE,
+                                chess::Side::kWhite));
+    CHECK(game.hash() != before);
+    CHECK(game.hash() == game.computeHash());
+  }
+  SECTION("King move undo restores castling rights") {
+    chess::test::playTestMove(game, "E2-E4");
+    chess::test::playTestMove(game, "E7-E5");
+    const std::uint64_t before = game.hash();
+    chess::test::playTestMove(game, "E1-E2");
+    game.undoLastMove();
+    CHECK(game.castlingAllowed(chess::BoardSide::KING_SIDE,
+                               chess::Side::kWhite));
+    CHECK(game.hash() == before);
+  }
+  SECTION("En passant file") {
+    chess::test::playTestMove(game, "E2-E4");
+    CHECK(!game.enPassantSquare().has_value());
+    chess::test::playTestMove(game, "A7-A6");
+    chess::test::playTestMove(game, "E4-E5");
+    chess::test::playTestMove(game, "D7-D5");
+    // D6, behind the pawn
+    CHECK(game.enPassantSquare() == 43);
+    CHECK(game.hash() == game.computeHash());
+    game.undoLastMove();
+    CHECK(!game.enPassantSquare().has_value());
+    CHECK(game.hash() == game.computeHash());
+  }
+}
+
+TEST_CASE("Game castling rights") {
+  chess::Game game;
+  CHECK(game.castlingRights() == chess::kAllCastlingRights);
+
+  SECTION("Rook move") {
+    chess::test::playTestMove(game, "H2-H4");
+    chess::test::playTestMove(game, "A7-A5");
+    chess::test::playTestMove(game, "H1-H3");
+    CHECK(game.castlingRights() ==
+          (chess::kAllCastlingRights &
+           ~chess::castlingRight(chess::Side::kWhite,
+                                 chess::BoardSide::KING_SIDE)));
+    chess::test::playTestMove(game, "A8-A6");
+    CHECK(!game.castlingAllowed(chess::BoardSide::QUEEN_SIDE,
+                                chess::Side::kBlack));
+    CHECK(game.castlingAllowed(chess::BoardSide::KING_SIDE,
+                               chess::Side::kBlack));
+    game.undoLastMove();
+    game.undoLastMove();
+    CHECK(game.castlingRights() == chess::kAllCastlingRights);
+  }
+  SECTION("Rook captured") {
+    chess::test::playTestMove(game, "G2-G3");
+    chess::test::playTestMove(game, "B7-B6");
+    chess::test::playTestMove(game, "F1-G2");
+    chess::test::playTestMove(game, "E7-E6");
+    chess::test::playTestMove(game, "G2-A8");
+    CHECK(!game.castlingAllowed(chess::BoardSide::QUEEN_SIDE,
+                                chess::Side::kBlack));
+    CHECK(game.castlingAllowed(chess::BoardSide::QUEEN_SIDE,
+                               chess::Side::kWhite));
+    CHECK(game.hash() == game.computeHash());
+  }
+}
+
+TEST_CASE("Game attacks") {
+  chess::Game game;
+
+  SECTION("Check") {
+    chess::test::playTestMove(game, "F2-F3");
+    chess::test::playTestMove(game, "E7-E5");
+    CHECK(!game.playerKingInCheck());
+    chess::test::playTestMove(game, "G2-G4");
+    chess::test::playTestMove(game, "D8-H4");
+    CHECK(game.playerKingInCheck());
+    CHECK(game.attacks() == chess::AttackMap{game.board()});
+    game.undoLastMove();
+    CHECK(!game.playerKingInCheck());
+    CHECK(game.attacks() == chess::AttackMap{game.board()});
+  }
+  SECTION("En passant") {
+    chess::test::playTestMove(game, "E2-E4");
+    chess::test::playTestMove(game, "A7-A6");
+    chess::test::playTestMove(game, "E4-E5");
+    chess::test::playTestMove(game, "D7-D5");
+    const chess::AttackMap before = game.attacks();
+    chess::EnPassant S_enPassant{.bApplied = true,
+                                 .PawnCaptured = chess::Position{4, 3}};
+    chess::Castling S_castling;
+    chess::Promotion S_promotion;
+    game.movePiece({4, 4}, {5, 3}, S_enPassant, S_castling, S_promotion);
+    CHECK(game.attacks() == chess::AttackMap{game.board()});
+    game.undoLastMove();
+    CHECK(game.attacks() == before);
+  }
+  SECTION("Castling") {
+    chess::test::playTestMove(game, "G1-F3");
+    chess::test::playTestMove(game, "G8-F6");
+    chess::test::playTestMove(game, "G2-G3");
+    chess::test::playTestMove(game, "G7-G6");
+    chess::test::playTestMove(game, "F1-G2");
+    chess::test::playTestMove(game, "F8-G7");
+    const chess::AttackMap before = game.attacks();
+    chess::EnPassant S_enPassant;
+    chess::Castling S_castling{.bApplied = true,
+                               .rook_before = chess::Position{0, 7},
+                               .rook_after = chess::Position{0, 5}};
+    chess::Promotion S_promotion;
+    game.movePiece({0, 4}, {0, 6}, S_enPassant, S_castling, S_promotion);
+    CHECK(game.attacks() == chess::AttackMap{game.board()});
+    CHECK(game.attacks().isAttacked(chess::Position{0, 4},
+                                    chess::Side::kWhite));
+    game.undoLastMove();
+    CHECK(game.attacks() == before);
+  }
+}
+
+TEST_CASE("Game makeMove and unmakeMove") {
+  chess::Game game;
+  CHECK(!game.undoIsPossible());
+
+  // Play generated moves, remembering each position
+  std::vector<std::uint64_t> hashes;
+  for (int ply = 0; ply < 40; ply++) {
+    chess::MoveList moves;
+    chess::generateLegalMoves(game, moves);
+    if (moves.empty()) {
+      break;
+    }
+    hashes.push_back(game.hash());
+    game.makeMove(moves[ply % moves.size()]);
+  }
+  CHECK(game.undoIsPossible());
+
+  while (!hashes.empty()) {
+    game.unmakeMove();
+    CHECK(game.hash() == hashes.back());
+    hashes.pop_back();
+  }
+  CHECK(!game.undoIsPossible());
+  CHECK(game.board() == chess::Board{});
+  CHECK(game.white_captured.empty());
+  CHECK(game.black_captured.empty());
+  CHECK(game.castlingAllowed(chess::BoardSide::KING_SIDE, chess::Side::kWhite));
+}
+
+TEST_CASE("Game status") {
+  chess::Game game;
+  const auto play = [&game](const std::string &text) {
+    const auto [from, to] = chess::parseMove(text);
+    const chess::MoveValidation result =
+        chess::validateMove(game, chess::Move{from, to});
+    REQUIRE(result.valid());
+    game.makeMove(result.move);
+  };
+  CHECK(game.status() == chess::GameStatus::kOngoing);
+
+  SECTION("Checkmate") {
+    for (const char *move : {"F2-F3", "E7-E5", "G2-G4", "D8-H4"}) {
+      play(move);
+    }
+    CHECK(game.status() == chess::GameStatus::kCheckmate);
+    CHECK(game.isCheckMate());
+    CHECK(game.isFinished());
+    game.unmakeMove();
+    CHECK(!game.isFinished());
+  }
+  SECTION("Stalemate") {
+    // The shortest known stalemate, found by Sam Loyd
+    for (const char *move :
+         {"E2-E3", "A7-A5", "D1-H5", "A8-A6", "H5-A5", "H7-H5", "H2-H4",
+          "A6-H6", "A5-C7", "F7-F6", "C7-D7", "E8-F7", "D7-B7", "D8-D3",
+          "B7-B8", "D3-H7", "B8-C8", "F7-G6"}) {
+      play(move);
+    }
+    CHECK(game.status() == chess::GameStatus::kOngoing);
+    play("C8-E6");
+    CHECK(game.status() == chess::GameStatus::kStalemate);
+    CHECK(!game.isCheckMate());
+    CHECK(game.isFinished());
+  }
+}
+
+TEST_CASE("Game draws") {
+  chess::Game game;
+  const auto play = [&game](const std::string &text) {
+    const auto [from, to] = chess::parseMove(text);
+    game.makeMove(chess::Move{from, to});
+  };
+  const std::array<const char *, 4> shuffle{"G1-F3", "G8-F6", "F3-G1",
+                                            "F6-G8"};
+
+  SECTION("Threefold repetition") {
+    for (const char *move : shuffle) {
+      play(move);
+    }
+    CHECK(!game.isThreefoldRepetition());
+    for (const char *move : shuffle) {
+      play(move);
+    }
+    CHECK(game.isThreefoldRepetition());
+    CHECK(game.status() == chess::GameStatus::kThreefoldRepetition);
+    CHECK(game.isFinished());
+
+    game.unmakeMove();
+    CHECK(!game.isThreefoldRepetition());
+  }
+  SECTION("A pawn move resets the clock") {
+    for (const char *move : shuffle) {
+      play(move);
+    }
+    play("E2-E4");
+    play("E7-E5");
+    for (const char *move : shuffle) {
+      play(move);
+    }
+    CHECK(!game.isThreefoldRepetition());
+    CHECK(game.halfmoveClock() == 4);
+  }
+  SECTION("Fifty-move rule") {
+    const std::array<const char *, 4> tour{"B1-C3", "B8-C6", "C3-B1",
+                                           "C6-B8"};
+    for (int ply = 0; ply < 100; ply++) {
+      play((ply / 4) % 2 == 0 ? shuffle[ply % 4] : tour[ply % 4]);
+      if (ply < 99) {
+        CHECK(!game.isFiftyMoveRule());
+      }
+    }
+    CHECK(game.halfmoveClock() == 100);
+    CHECK(game.isFiftyMoveRule());
+    CHECK(game.status() == chess::GameStatus::kFiftyMoveRule);
+  }
+}
+
 #endif
@@ -1,10 +1,16 @@
 #pragma once
+#include "attack_map.hpp"
+#include "check_info.hpp"
 #include "chess.hpp"
+#include "game_state.hpp"
+#include "move.hpp"
 
 #include <array>
+#include <cstdint>
 #include <deque>
 #include <exception>
-#include <map>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace chess {
@@ -16,11 +22,40 @@ public:
   GameException(const std::string &err) : std::runtime_error(err) {}
 };
 
+/// @brief A game being played: the current GameState with the moves and
+///  captures that led to it.
 class Game {
 public:
+  Game() = default;
+
+  /// Starts a game from @a state instead of the initial position.
+  explicit Game(const GameState &state);
+
+  /// @brief Starts a game from a position in Forsyth-Edwards Notation.
+  /// @throws GameException if @a fen is malformed.
+  [[nodiscard]] static Game fromFen(std::string_view fen);
+
+  /// @return The current position in Forsyth-Edwards Notation.
+  [[nodiscard]] std::string toFen() const;
+
+  /// @brief Plays the move validated by isMoveValid() and logs it in rounds.
   void movePiece(Position present, Position future, EnPassant &S_enPassant,
                  Castling &S_castling, Promotion &S_promotion);
 
+  /// Plays @a move, which must be legal, and logs it in rounds.
+  void playMove(Move move);
+
+  /// @brief Plays @a move, which must be legal, without logging it.
+  ///
+  /// Every move made is kept on a stack, so any number of them can be taken
+  /// back with unmakeMove().
+  void makeMove(Move move);
+
+  /// Takes back the last move made, which must exist. The move log is left
+  /// untouched.
+  void unmakeMove();
+
+  /// Takes back the last move and removes it from the move log.
   void undoLastMove();
 
   bool undoIsPossible() const;
@@ -42,15 +77,21 @@ public:
 
   bool isReachable(Position pos, Side side) const;
 
+  /// Same as isReachable(Position, Side), with the attacks of the current
+  /// position already gathered in @a attacks.
+  bool isReachable(Position pos, Side side, const AttackMap &attacks) const;
+
   bool isSquareOccupied(Position pos) const;
 
   bool isPathFree(Position startingPos, Position finishingPos,
                   Direction iDirection) const;
 
-  bool canBeBlocked(Position startingPos, Position finishinPos,
-                    Direction iDirection) const;
+  /// @return Whether the side to move is checkmated, stalemated or can
+  ///  still play, decided by looking for a single legal move, and else
+  ///  whether the game is drawn by repetition or by the fifty-move rule.
+  [[nodiscard]] GameStatus status() const;
 
-  bool isCheckMate();
+  bool isCheckMate() const;
 
   bool playerKingInCheck(
       const std::optional<IntendedMove> &intended_move = std::nullopt) const;
@@ -58,8 +99,7 @@ public:
   bool wouldKingBeInCheck(PieceWithSide piece, Position present,
                           Position future, EnPassant &S_enPassant) const;
 
-  void changeTurns();
-
+  /// @return True once status() is no longer GameStatus::kOngoing.
   bool isFinished() const;
 
   Side getCurrentTurn() const;
@@ -69,16 +109,41 @@ public:
   std::tuple<Position, Position, SquareState>
   parseMoveWithPromotion(const std::string &move) const;
 
-  void logMove(std::string &to_record);
-
-  std::string getLastMove() const;
+  std::optional<Move> getLastMove() const;
 
   void deleteLastMove();
 
+  /// @return The Zobrist key of the current position. It covers the pieces,
+  /// the side to move, the castling rights and the en passant file, and is
+  /// updated incrementally by makeMove and unmakeMove.
+  std::uint64_t hash() const;
+
+  /// @return The position key recomputed from scratch.
+  std::uint64_t computeHash() const;
+
+  /// @return The square behind the pawn that can be captured en passant on
+  /// this move, where the capturing pawn lands, if any.
+  std::optional<int> enPassantSquare() const;
+
+  /// @return The castlings still allowed, see castlingRight().
+  CastlingRights castlingRights() const;
+
+  /// @return The number of halfmoves since the last capture or pawn move.
+  int halfmoveClock() const;
+
+  /// @return True if the current position occurred twice before with the same
+  ///  side to move, castling rights and en passant square.
+  bool isThreefoldRepetition() const;
+
+  /// @return True once a hundred halfmoves went by without a capture or a
+  ///  pawn move.
+  bool isFiftyMoveRule() const;
+
   // Save all the moves
+  // A game set up with black to move starts with a round without a white move
   struct Round {
-    std::string white_move;
-    std::string black_move;
+    std::optional<Move> white_move;
+    std::optional<Move> black_move;
   };
 
   std::deque<Round> rounds;
@@ -89,36 +154,49 @@ public:
 
   const Board &board() const;
 
+  /// The position alone, without the history of the game.
+  const GameState &state() const;
+
+  /// The position the game started from, before the moves in rounds.
+  const GameState &initialState() const;
+
+  /// Attacks of the current position, kept up to date move by move.
+  const AttackMap &attacks() const;
+
+  /// Checkers of, and pins against, the king of the side to move.
+  const CheckInfo &checkInfo() const;
+
 private:
+  void logMove(Move move);
+
   void capturePiece(PieceWithSide piece);
 
 private:
-  chess::Board m_board;
+  GameState m_initialState;
 
-  // Undo is possible?
-  struct Undo {
-    bool bCanUndo = false;
-    bool bCapturedLastMove = false;
+  GameState m_state = m_initialState;
 
-    bool bCastlingKingSideAllowed = false;
-    bool bCastlingQueenSideAllowed = false;
+  // Attacks on the board, updated by makeMove and unmakeMove
+  AttackMap m_attacks{m_state.board()};
 
-    std::optional<EnPassant> en_passant;
-    std::optional<Castling> castling;
-    std::optional<Promotion> promotion;
-  } m_undo;
+  // Checks and pins against the side to move, recomputed after every move
+  CheckInfo m_checkInfo{m_state.board(), m_state.sideToMove()};
 
-  // Castling requirements
-  std::map<Side, bool> m_bCastlingKingSideAllowed{{Side::kWhite, true},
-                                                  {Side::kBlack, true}};
-  std::map<Side, bool> m_bCastlingQueenSideAllowed{{Side::kWhite, true},
-                                                   {Side::kBlack, true}};
+  // What makeMove() changed, for unmakeMove() to revert
+  struct UndoRecord {
+    GameState::Undo state;
+
+    CheckInfo check_info;
+
+    // What restore() needs to take the attack map back
+    AttackMap::Delta attacks;
+  };
 
-  // Holds the current turn
-  Side m_CurrentTurn = Side::kWhite;
+  std::vector<UndoRecord> m_undoStack;
 
-  // Has the game finished already?
-  bool m_bGameFinished = false;
+  // Keys of the positions before each move, pushed by makeMove and popped by
+  // unmakeMove, to find repetitions
+  std::vector<std::uint64_t> m_positionKeys;
 };
 
 void makeTheMove(chess::Game &current_game, chess::Position present,
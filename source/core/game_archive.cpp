@@ -0,0 +1,253 @@
+#include "game_archive.hpp"
+#include "byte_order.hpp"
+#include "game.hpp"
+#include "validation.hpp"
+
+#include <array>
+#include <cassert>
+
+namespace chess {
+namespace {
+constexpr std::array<char, 4> kMagic{'C', 'C', 'G', 'A'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 24;
+constexpr std::size_t kMaxFenLength = 255;
+} // namespace
+
+ArchivedGame::ArchivedGame(const std::string_view fen,
+                           const std::byte *const moves,
+                           const std::size_t move_count)
+    : mFen(fen), mMoves(moves), mMoveCount(move_count) {}
+
+std::string_view ArchivedGame::fen() const { return mFen; }
+
+std::size_t ArchivedGame::moveCount() const { return mMoveCount; }
+
+Move ArchivedGame::move(const std::size_t index) const {
+  assert(index < mMoveCount);
+  return Move::fromBits(readLittleEndian<std::uint16_t>(
+      {mMoves, mMoveCount * sizeof(std::uint16_t)},
+      index * sizeof(std::uint16_t)));
+}
+
+Game ArchivedGame::replay() const {
+  Game game = mFen.empty() ? Game{} : Game::fromFen(mFen);
+  for (std::size_t i = 0; i < mMoveCount; i++) {
+    const Move archived = move(i);
+    const MoveValidation result = validateMove(game, archived);
+    if (!result.valid() || result.move != archived) {
+      throw GameException("illegal move " + toString(archived) +
+                          " at ply " + std::to_string(i + 1));
+    }
+    game.playMove(archived);
+  }
+  return game;
+}
+
+GameArchive::GameArchive(const std::filesystem::path &file) : mFile(file) {
+  const std::span<const std::byte> bytes = mFile.bytes();
+  if (bytes.size() < kHeaderSize) {
+    throw GameException(file.string() + " is not a game archive");
+  }
+  for (std::size_t i = 0; i < kMagic.size(); i++) {
+    if (bytes[i] != static_cast<std::byte>(kMagic[i])) {
+      throw GameException(file.string() + " is not a game archive");
+    }
+  }
+  if (readLittleEndian<std::uint32_t>(bytes, 4) != kVersion) {
+    throw GameException(file.string() + " has an unknown archive version");
+  }
+
+  const std::uint64_t game_count = readLittleEndian<std::uint64_t>(bytes, 8);
+  const std::uint64_t index_offset =
+      readLittleEndian<std::uint64_t>(bytes, 16);
+  const std::uint64_t index_entries =
+      index_offset < bytes.size()
+          ? (bytes.size() - index_offset) / sizeof(std::uint64_t)
+          : 0;
+  if (index_offset < kHeaderSize || game_count >= index_entries) {
+    throw GameException(file.string() + " has a damaged index");
+  }
+  mGameCount = static_cast<std::size_t>(game_count);
+  mIndexOffset = static_cast<std::size_t>(index_offset);
+}
+
+std::size_t GameArchive::size() const { return mGameCount; }
+
+ArchivedGame GameArchive::operator[](const std::size_t index) const {
+  assert(index < mGameCount);
+  const std::span<const std::byte> bytes = mFile.bytes();
+  const std::uint64_t start = offset(index);
+  const std::uint64_t end = offset(index + 1);
+  if (start < kHeaderSize || start >= end || end > mIndexOffset) {
+    throw GameException("Damaged record in game archive");
+  }
+
+  std::size_t position = static_cast<std::size_t>(start);
+  std::string_view fen;
+  if (bytes[position++] != std::byte{0}) {
+    const std::size_t length = std::to_integer<std::size_t>(bytes[position++]);
+    if (position + length > end) {
+      throw GameException("Damaged record in game archive");
+    }
+    fen = {reinterpret_cast<const char *>(bytes.data() + position), length};
+    position += length;
+  }
+  if ((end - position) % sizeof(std::uint16_t) != 0) {
+    throw GameException("Damaged record in game archive");
+  }
+  return ArchivedGame{fen, bytes.data() + position,
+                      static_cast<std::size_t>((end - position) /
+                                               sizeof(std::uint16_t))};
+}
+
+std::uint64_t GameArchive::offset(const std::size_t index) const {
+  return readLittleEndian<std::uint64_t>(
+      mFile.bytes(), mIndexOffset + index * sizeof(std::uint64_t));
+}
+
+ArchiveWriter::ArchiveWriter(const std::filesystem::path &file)
+    : mStream(file, std::ios::binary | std::ios::trunc) {
+  if (!mStream) {
+    throw GameException("Can't create " + file.string());
+  }
+  // The header is written by finish(), once the index is known
+  writeBytes(mStream, std::vector<std::byte>(kHeaderSize));
+  mOffsets.push_back(kHeaderSize);
+}
+
+ArchiveWriter::~ArchiveWriter() {
+  if (!mFinished) {
+    try {
+      finish();
+    } catch (const GameException &) {
+    }
+  }
+}
+
+void ArchiveWriter::add(const Game &game) {
+  std::vector<Move> moves;
+  for (const Game::Round &round : game.rounds) {
+    for (const std::optional<Move> &move :
+         {round.white_move, round.black_move}) {
+      if (move) {
+        moves.push_back(*move);
+      }
+    }
+  }
+  const std::string fen = game.initialState().toFen();
+  add(fen == kStartFen ? std::string_view{} : std::string_view{fen}, moves);
+}
+
+void ArchiveWriter::add(const std::string_view fen,
+                        const std::span<const Move> moves) {
+  assert(!mFinished);
+  mRecord.clear();
+  if (fen.empty()) {
+    mRecord.push_back(std::byte{0});
+  } else {
+    assert(fen.size() <= kMaxFenLength);
+    mRecord.push_back(std::byte{1});
+    mRecord.push_back(static_cast<std::byte>(fen.size()));
+    for (const char c : fen) {
+      mRecord.push_back(static_cast<std::byte>(c));
+    }
+  }
+  for (const Move &move : moves) {
+    appendLittleEndian(mRecord, move.bits());
+  }
+  writeBytes(mStream, mRecord);
+  mOffsets.push_back(mOffsets.back() + mRecord.size());
+}
+
+void ArchiveWriter::finish() {
+  mFinished = true;
+  const std::uint64_t index_offset = mOffsets.back();
+  std::vector<std::byte> bytes;
+  for (const std::uint64_t offset : mOffsets) {
+    appendLittleEndian(bytes, offset);
+  }
+  writeBytes(mStream, bytes);
+
+  bytes.clear();
+  for (const char c : kMagic) {
+    bytes.push_back(static_cast<std::byte>(c));
+  }
+  appendLittleEndian(bytes, kVersion);
+  const std::uint64_t game_count = mOffsets.size() - 1;
+  appendLittleEndian(bytes, game_count);
+  appendLittleEndian(bytes, index_offset);
+  mStream.seekp(0);
+  writeBytes(mStream, bytes);
+
+  mStream.close();
+  if (!mStream) {
+    throw GameException("Failed to write the game archive");
+  }
+}
+} // namespace chess
+
+#if defined(UNIT_TEST)
+
+#include "load_save.hpp"
+#include "temp_file.hpp"
+#include "test_utility.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("GameArchive") {
+  const std::filesystem::path file = chess::uniqueTempPath(
+      std::filesystem::temp_directory_path(), "chess_archive_test.cga");
+
+  // En passant, castling and an under-promotion from the initial position
+  chess::Game first;
+  for (const char *move :
+       {"E2-E4", "D7-D5", "E4-E5", "F7-F5", "E5-F6", "G8-H6", "F1-E2", "E7-E6",
+        "G1-F3", "F8-E7", "E1-G1", "E8-G8", "F6-G7", "A7-A6"}) {
+    chess::test::playLegalMove(first, move);
+  }
+  chess::test::playLegalMove(first, "G7-F8", chess::Piece::kKnight);
+
+  // Black to move first
+  chess::Game second = chess::Game::fromFen(
+      "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1");
+  chess::test::playLegalMove(second, "C7-C5");
+
+  {
+    chess::ArchiveWriter writer{file};
+    writer.add(first);
+    writer.add(second);
+    writer.add(chess::Game{});
+    writer.finish();
+  }
+
+  const chess::GameArchive archive{file};
+  REQUIRE(archive.size() == 3);
+
+  const chess::ArchivedGame archived = archive[0];
+  CHECK(archived.fen().empty());
+  REQUIRE(archived.moveCount() == 15);
+  CHECK(archived.move(4).flag() == chess::MoveFlag::kEnPassant);
+  CHECK(archived.move(10).flag() == chess::MoveFlag::kCastling);
+  CHECK(archived.move(11).flag() == chess::MoveFlag::kCastling);
+  CHECK(archived.move(14).promotion() == chess::Piece::kKnight);
+  const chess::Game replayed = archived.replay();
+  CHECK(replayed.toFen() == first.toFen());
+  CHECK(replayed.rounds.size() == first.rounds.size());
+
+  CHECK(archive[1].fen() == second.initialState().toFen());
+  CHECK(archive[1].replay().toFen() == second.toFen());
+  CHECK(archive[2].moveCount() == 0);
+
+  SECTION("saveGame and loadGame") {
+    chess::saveGame(second, file);
+    CHECK(chess::loadGame(file).toFen() == second.toFen());
+  }
+  SECTION("Not an archive") {
+    std::ofstream{file} << "E2-E4 | E7-E5\n";
+    CHECK_THROWS_AS(chess::GameArchive{file}, chess::GameException);
+  }
+  std::filesystem::remove(file);
+}
+
+#endif
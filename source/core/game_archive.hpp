@@ -0,0 +1,104 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include "move.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace chess {
+class Game;
+
+/// File extension of game archives
+inline constexpr std::string_view kArchiveExtension = ".cga";
+
+/// @brief One game inside a GameArchive, read in place from the mapping.
+///
+/// It stays valid as long as the archive it came from.
+class ArchivedGame {
+public:
+  /// @return The position the game starts from in Forsyth-Edwards Notation,
+  ///  or an empty string for the initial position.
+  [[nodiscard]] std::string_view fen() const;
+
+  [[nodiscard]] std::size_t moveCount() const;
+
+  [[nodiscard]] Move move(std::size_t index) const;
+
+  /// @brief Plays the moves into a new Game, checking each one.
+  /// @throws GameException if a move is not legal.
+  [[nodiscard]] Game replay() const;
+
+private:
+  friend class GameArchive;
+
+  ArchivedGame(std::string_view fen, const std::byte *moves,
+               std::size_t move_count);
+
+  std::string_view mFen;
+  const std::byte *mMoves = nullptr;
+  std::size_t mMoveCount = 0;
+};
+
+/// @brief Reads a file written by ArchiveWriter through a memory mapping.
+///
+/// The file starts with a 24 byte header: the magic "CCGA", a 32 bit version,
+/// the 64 bit number of games and the 64 bit offset of the index. Each game
+/// record holds a byte that is 1 when a FEN follows, the FEN length in one
+/// byte and its text, then every move as the 16 bits of Move::bits(). The
+/// index holds the offset of every record and one past the last. All numbers
+/// are little endian.
+class GameArchive {
+public:
+  /// @throws GameException if @a file can not be read or is not an archive.
+  explicit GameArchive(const std::filesystem::path &file);
+
+  [[nodiscard]] std::size_t size() const;
+
+  /// @throws GameException if the record of game @a index is damaged.
+  [[nodiscard]] ArchivedGame operator[](std::size_t index) const;
+
+private:
+  [[nodiscard]] std::uint64_t offset(std::size_t index) const;
+
+  MappedFile mFile;
+  std::size_t mGameCount = 0;
+  std::size_t mIndexOffset = 0;
+};
+
+/// @brief Writes games one after another into a new archive, see
+///  GameArchive for the layout.
+class ArchiveWriter {
+public:
+  /// @throws GameException if @a file can not be created.
+  explicit ArchiveWriter(const std::filesystem::path &file);
+
+  /// Calls finish() if it was not called yet, ignoring any failure.
+  ~ArchiveWriter();
+
+  ArchiveWriter(const ArchiveWriter &) = delete;
+  ArchiveWriter &operator=(const ArchiveWriter &) = delete;
+
+  /// Appends the moves logged in @a game, from its initial state.
+  void add(const Game &game);
+
+  /// Appends the game playing @a moves from @a fen, or from the initial
+  /// position if @a fen is empty.
+  void add(std::string_view fen, std::span<const Move> moves);
+
+  /// @brief Writes the index and the header.
+  /// @throws GameException if the file could not be written.
+  void finish();
+
+private:
+  std::ofstream mStream;
+  std::vector<std::uint64_t> mOffsets;
+  std::vector<std::byte> mRecord;
+  bool mFinished = false;
+};
+} // namespace chess
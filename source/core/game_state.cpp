@@ -0,0 +1,567 @@
+#include "game_state.hpp"
+#include "attacks.hpp"
+#include "game.hpp"
+#include "zobrist.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <charconv>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace chess {
+namespace {
+/// @return The squares directly left and right of @a pos.
+Bitboard horizontalNeighbours(const Position pos) {
+  Bitboard neighbours = kEmptyBitboard;
+  if (pos.iColumn > 0) {
+    neighbours |= positionBit({pos.iRow, pos.iColumn - 1});
+  }
+  if (pos.iColumn < kNumCols - 1) {
+    neighbours |= positionBit({pos.iRow, pos.iColumn + 1});
+  }
+  return neighbours;
+}
+
+/// @return The castling rights lost when a piece leaves @a square or is
+/// captured on it: the initial squares of the kings and rooks.
+CastlingRights castlingRightsLostOn(const int square) {
+  switch (square) {
+  case 0:
+    return castlingRight(Side::kWhite, BoardSide::QUEEN_SIDE);
+  case 4:
+    return castlingRight(Side::kWhite, BoardSide::QUEEN_SIDE) |
+           castlingRight(Side::kWhite, BoardSide::KING_SIDE);
+  case 7:
+    return castlingRight(Side::kWhite, BoardSide::KING_SIDE);
+  case 56:
+    return castlingRight(Side::kBlack, BoardSide::QUEEN_SIDE);
+  case 60:
+    return castlingRight(Side::kBlack, BoardSide::QUEEN_SIDE) |
+           castlingRight(Side::kBlack, BoardSide::KING_SIDE);
+  case 63:
+    return castlingRight(Side::kBlack, BoardSide::KING_SIDE);
+  default:
+    return kNoCastlingRights;
+  }
+}
+
+/// @return Where the rook of the castling @a move stands before and after it.
+std::pair<Position, Position> castlingRookJump(const Move &move) {
+  const Position from = move.from();
+  const Position to = move.to();
+  const bool king_side = to.iColumn > from.iColumn;
+  return {{.iRow = from.iRow, .iColumn = king_side ? kNumCols - 1 : 0},
+          {.iRow = from.iRow,
+           .iColumn = king_side ? to.iColumn - 1 : to.iColumn + 1}};
+}
+
+/// The first and last rows, where no pawn can stand
+constexpr Bitboard kBackRanks = 0xFF000000000000FFULL;
+
+/// The FEN letters of the castling rights, in the order they are written
+constexpr std::array<std::pair<char, CastlingRights>, 4> kCastlingLetters{
+    {{'K', castlingRight(Side::kWhite, BoardSide::KING_SIDE)},
+     {'Q', castlingRight(Side::kWhite, BoardSide::QUEEN_SIDE)},
+     {'k', castlingRight(Side::kBlack, BoardSide::KING_SIDE)},
+     {'q', castlingRight(Side::kBlack, BoardSide::QUEEN_SIDE)}}};
+
+[[noreturn]] void invalidFen(const std::string_view fen,
+                             const std::string &reason) {
+  throw GameException("Invalid FEN \"" + std::string{fen} + "\": " + reason);
+}
+
+std::vector<std::string_view> splitFields(std::string_view text) {
+  std::vector<std::string_view> fields;
+  while (!text.empty()) {
+    const std::size_t start = text.find_first_not_of(' ');
+    if (start == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(start);
+    const std::size_t end = std::min(text.find(' '), text.size());
+    fields.push_back(text.substr(0, end));
+    text.remove_prefix(end);
+  }
+  return fields;
+}
+
+Board parsePlacement(const std::string_view fen,
+                     const std::string_view placement) {
+  Board::BoardArray squares{};
+  std::array<int, 12> counts{};
+  int row = kNumRows - 1;
+  int column = 0;
+  for (const char c : placement) {
+    if (c == '/') {
+      if (column != kNumCols || row == 0) {
+        invalidFen(fen, "every row must hold eight squares");
+      }
+      row--;
+      column = 0;
+    } else if (c >= '1' && c <= '8') {
+      column += c - '0';
+    } else if (std::string_view{"PRNBQKprnbqk"}.find(c) !=
+               std::string_view::npos) {
+      if (column >= kNumCols) {
+        invalidFen(fen, "every row must hold eight squares");
+      }
+      const PieceWithSide piece = charToPiece(c);
+      const int kind = static_cast<int>(piece.mSide) * 6 +
+                       static_cast<int>(piece.mPiece);
+      if (++counts[kind] > Board::kMaxPiecesOfKind) {
+        invalidFen(fen, "too many pieces of one kind");
+      }
+      squares[row * kNumCols + column++] = piece;
+    } else {
+      invalidFen(fen, std::string{"unexpected '"} + c + "' on the board");
+    }
+    if (column > kNumCols) {
+      invalidFen(fen, "every row must hold eight squares");
+    }
+  }
+  if (row != 0 || column != kNumCols) {
+    invalidFen(fen, "the board must have eight rows of eight squares");
+  }
+
+  const Board board{squares};
+  for (const Side side : {Side::kWhite, Side::kBlack}) {
+    if (popCount(board.pieces(Piece::kKing, side)) != 1) {
+      invalidFen(fen, "each side needs exactly one king");
+    }
+    if (popCount(board.pieces(Piece::kPawn, side)) > kNumCols) {
+      invalidFen(fen, "a side can not have more than eight pawns");
+    }
+    if (popCount(board.pieces(side)) > 2 * kNumCols) {
+      invalidFen(fen, "a side can not have more than sixteen pieces");
+    }
+  }
+  // Move generation relies on pawns always having a square in front of them
+  if (board.pieces(Piece::kPawn) & kBackRanks) {
+    invalidFen(fen, "pawns can not stand on the first or last row");
+  }
+  return board;
+}
+
+int parseClock(const std::string_view fen, const std::string_view field) {
+  int value = 0;
+  const auto [end, error] =
+      std::from_chars(field.data(), field.data() + field.size(), value);
+  if (error != std::errc{} || end != field.data() + field.size() ||
+      value < 0) {
+    invalidFen(fen, "bad move clock \"" + std::string{field} + "\"");
+  }
+  return value;
+}
+} // namespace
+
+static_assert(std::is_trivially_copyable_v<GameState>);
+
+GameState::GameState() {
+  // The board keys the pieces itself, keep only the remaining state here
+  mStateHash = computeHash() ^ mBoard.hash();
+}
+
+GameState GameState::fromFen(const std::string_view fen) {
+  const std::vector<std::string_view> fields = splitFields(fen);
+  if (fields.size() != 4 && fields.size() != 6) {
+    invalidFen(fen, "expected four or six fields");
+  }
+
+  GameState state;
+  state.mBoard = parsePlacement(fen, fields[0]);
+
+  if (fields[1] == "w") {
+    state.mSideToMove = Side::kWhite;
+  } else if (fields[1] == "b") {
+    state.mSideToMove = Side::kBlack;
+  } else {
+    invalidFen(fen, "the side to move must be w or b");
+  }
+
+  state.mCastlingRights = kNoCastlingRights;
+  if (fields[2] != "-") {
+    for (const char c : fields[2]) {
+      const auto *const letter = std::ranges::find(
+          kCastlingLetters, c, &std::pair<char, CastlingRights>::first);
+      if (letter == kCastlingLetters.end() ||
+          (state.mCastlingRights & letter->second)) {
+        invalidFen(fen, "bad castling rights \"" + std::string{fields[2]} +
+                            "\"");
+      }
+      state.mCastlingRights |= letter->second;
+    }
+  }
+
+  state.mEnPassantSquare = std::nullopt;
+  if (fields[3] != "-") {
+    const std::string_view square = fields[3];
+    const int row = state.mSideToMove == Side::kWhite ? 5 : 2;
+    if (square.size() != 2 || square[0] < 'a' || square[0] > 'h' ||
+        square[1] - '1' != row) {
+      invalidFen(fen, "bad en passant square \"" + std::string{square} + "\"");
+    }
+    const int target = row * kNumCols + (square[0] - 'a');
+    // The pawn that just moved two squares passed the target, so it stands
+    // in front of it with the target and the square it came from empty
+    const int forward = state.mSideToMove == Side::kWhite ? -kNumCols
+                                                          : kNumCols;
+    const Side mover = opponentSide(state.mSideToMove);
+    if (!(state.mBoard.pieces(Piece::kPawn, mover) &
+          squareBit(target + forward)) ||
+        (state.mBoard.occupied() &
+         (squareBit(target) | squareBit(target - forward)))) {
+      invalidFen(fen, "no pawn has just moved past the en passant square \"" +
+                          std::string{square} + "\"");
+    }
+    // Keyed and kept only when it matters, as makeMove() does
+    if (pawnAttacks(opponentSide(state.mSideToMove), target) &
+        state.mBoard.pieces(Piece::kPawn, state.mSideToMove)) {
+      state.mEnPassantSquare = target;
+    }
+  }
+
+  if (fields.size() == 6) {
+    state.mHalfmoveClock = parseClock(fen, fields[4]);
+    state.mFullmoveNumber = parseClock(fen, fields[5]);
+    if (state.mFullmoveNumber == 0) {
+      invalidFen(fen, "the move number starts at 1");
+    }
+  }
+
+  state.mStateHash = state.computeHash() ^ state.mBoard.hash();
+  return state;
+}
+
+std::string GameState::toFen() const {
+  std::string fen;
+  for (int row = kNumRows - 1; row >= 0; row--) {
+    int empty = 0;
+    for (int column = 0; column < kNumCols; column++) {
+      if (const SquareState square = mBoard(row, column)) {
+        if (empty > 0) {
+          fen += static_cast<char>('0' + empty);
+          empty = 0;
+        }
+        fen += pieceToChar(*square);
+      } else {
+        empty++;
+      }
+    }
+    if (empty > 0) {
+      fen += static_cast<char>('0' + empty);
+    }
+    if (row > 0) {
+      fen += '/';
+    }
+  }
+
+  fen += mSideToMove == Side::kWhite ? " w " : " b ";
+
+  if (mCastlingRights == kNoCastlingRights) {
+    fen += '-';
+  }
+  for (const auto &[letter, right] : kCastlingLetters) {
+    if (mCastlingRights & right) {
+      fen += letter;
+    }
+  }
+
+  fen += ' ';
+  if (mEnPassantSquare) {
+    fen += static_cast<char>('a' + *mEnPassantSquare % kNumCols);
+    fen += static_cast<char>('1' + *mEnPassantSquare / kNumCols);
+  } else {
+    fen += '-';
+  }
+
+  fen += ' ' + std::to_string(mHalfmoveClock) + ' ' +
+         std::to_string(mFullmoveNumber);
+  return fen;
+}
+
+GameState::Undo GameState::makeMove(const Move move) {
+  const SquareState piece = mBoard(move.from());
+  assert(piece);
+
+  Undo undo{.move = move,
+            .moved = *piece,
+            .captured = std::nullopt,
+            .capturedSquare = move.to(),
+            .castlingRights = mCastlingRights,
+            .enPassantSquare = mEnPassantSquare,
+            .halfmoveClock = mHalfmoveClock,
+            .changed = squareBit(move.fromSquare()) |
+                       squareBit(move.toSquare())};
+
+  // The pawn taken en passant is not on the destination square
+  if (move.flag() == MoveFlag::kEnPassant) {
+    undo.capturedSquare = {.iRow = move.from().iRow,
+                           .iColumn = move.to().iColumn};
+    undo.changed |= positionBit(undo.capturedSquare);
+    undo.captured = mBoard(undo.capturedSquare);
+    mBoard.setSquare(undo.capturedSquare, pieces::E);
+  } else {
+    undo.captured = mBoard(move.to());
+  }
+
+  // Move the piece, or the piece it is promoted to
+  mBoard.setSquare(move.from(), pieces::E);
+  if (move.flag() == MoveFlag::kPromotion) {
+    mBoard.setSquare(move.to(), PieceWithSide{move.promotion(), mSideToMove});
+  } else {
+    mBoard.setSquare(move.to(), piece);
+  }
+
+  // The king was already moved, but we still have to move the rook to 'jump'
+  // the king
+  if (move.flag() == MoveFlag::kCastling) {
+    const auto [rook_before, rook_after] = castlingRookJump(move);
+    mBoard.setSquare(rook_after, mBoard(rook_before));
+    mBoard.setSquare(rook_before, pieces::E);
+    undo.changed |= positionBit(rook_before) | positionBit(rook_after);
+  }
+
+  // Once the king or a rook leaves its initial square, or the rook is
+  // captured there, that castling is gone for good
+  if (const CastlingRights lost = castlingRightsLostOn(move.fromSquare()) |
+                                  castlingRightsLostOn(move.toSquare());
+      mCastlingRights & lost) {
+    setCastlingRights(static_cast<CastlingRights>(mCastlingRights & ~lost));
+  }
+
+  // A pawn that moved two squares can be taken en passant on the next move,
+  // if an opponent pawn stands next to it
+  if (piece->mPiece == Piece::kPawn &&
+      2 == std::abs(move.to().iRow - move.from().iRow) &&
+      (mBoard.pieces(Piece::kPawn, opponentSide(mSideToMove)) &
+       horizontalNeighbours(move.to()))) {
+    setEnPassantSquare(
+        positionToSquare({.iRow = (move.from().iRow + move.to().iRow) / 2,
+                          .iColumn = move.to().iColumn}));
+  } else {
+    setEnPassantSquare(std::nullopt);
+  }
+
+  if (piece->mPiece == Piece::kPawn || undo.captured) {
+    mHalfmoveClock = 0;
+  } else {
+    mHalfmoveClock++;
+  }
+  if (mSideToMove == Side::kBlack) {
+    mFullmoveNumber++;
+  }
+  changeTurns();
+
+  assert(hash() == computeHash());
+  return undo;
+}
+
+void GameState::unmakeMove(const Undo &undo) {
+  const Move &move = undo.move;
+
+  changeTurns();
+  if (mSideToMove == Side::kBlack) {
+    mFullmoveNumber--;
+  }
+  mHalfmoveClock = undo.halfmoveClock;
+
+  // Put the piece back as it was before a promotion, and the captured piece
+  // with it
+  mBoard.setSquare(move.to(), pieces::E);
+  mBoard.setSquare(move.from(), undo.moved);
+  if (undo.captured) {
+    mBoard.setSquare(undo.capturedSquare, *undo.captured);
+  }
+
+  if (move.flag() == MoveFlag::kCastling) {
+    const auto [rook_before, rook_after] = castlingRookJump(move);
+    mBoard.setSquare(rook_before, mBoard(rook_after));
+    mBoard.setSquare(rook_after, pieces::E);
+  }
+
+  setCastlingRights(undo.castlingRights);
+  setEnPassantSquare(undo.enPassantSquare);
+
+  assert(hash() == computeHash());
+}
+
+const Board &GameState::board() const { return mBoard; }
+
+Side GameState::sideToMove() const { return mSideToMove; }
+
+CastlingRights GameState::castlingRights() const { return mCastlingRights; }
+
+bool GameState::castlingAllowed(const BoardSide board_side,
+                                const Side side) const {
+  return (mCastlingRights & castlingRight(side, board_side)) != 0;
+}
+
+std::optional<int> GameState::enPassantSquare() const {
+  return mEnPassantSquare;
+}
+
+int GameState::halfmoveClock() const { return mHalfmoveClock; }
+
+int GameState::fullmoveNumber() const { return mFullmoveNumber; }
+
+std::uint64_t GameState::hash() const { return mBoard.hash() ^ mStateHash; }
+
+std::uint64_t GameState::computeHash() const {
+  std::uint64_t key = 0;
+  for (const int square : BitboardSquares{mBoard.occupied()}) {
+    key ^= zobrist::pieceKey(*mBoard(squareToPosition(square)), square);
+  }
+  if (Side::kBlack == mSideToMove) {
+    key ^= zobrist::sideKey();
+  }
+  key ^= zobrist::castlingKey(mCastlingRights);
+  if (mEnPassantSquare) {
+    key ^= zobrist::enPassantKey(*mEnPassantSquare % kNumCols);
+  }
+  return key;
+}
+
+void GameState::changeTurns() {
+  mSideToMove = opponentSide(mSideToMove);
+  mStateHash ^= zobrist::sideKey();
+}
+
+void GameState::setCastlingRights(const CastlingRights rights) {
+  mStateHash ^=
+      zobrist::castlingKey(mCastlingRights) ^ zobrist::castlingKey(rights);
+  mCastlingRights = rights;
+}
+
+void GameState::setEnPassantSquare(const std::optional<int> square) {
+  if (mEnPassantSquare) {
+    mStateHash ^= zobrist::enPassantKey(*mEnPassantSquare % kNumCols);
+  }
+  mEnPassantSquare = square;
+  if (mEnPassantSquare) {
+    mStateHash ^= zobrist::enPassantKey(*mEnPassantSquare % kNumCols);
+  }
+}
+
+} // namespace chess
+
+#if defined(UNIT_TEST)
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+#include <utility>
+
+TEST_CASE("GameState clocks") {
+  chess::GameState state;
+  CHECK(state.halfmoveClock() == 0);
+  CHECK(state.fullmoveNumber() == 1);
+
+  const auto knight = state.makeMove(
+      chess::Move{chess::Position{0, 6}, chess::Position{2, 5}});
+  CHECK(state.halfmoveClock() == 1);
+  CHECK(state.fullmoveNumber() == 1);
+  const auto pawn = state.makeMove(
+      chess::Move{chess::Position{6, 4}, chess::Position{4, 4}});
+  CHECK(state.halfmoveClock() == 0);
+  CHECK(state.fullmoveNumber() == 2);
+  CHECK(state.sideToMove() == chess::Side::kWhite);
+
+  state.unmakeMove(pawn);
+  CHECK(state.halfmoveClock() == 1);
+  CHECK(state.fullmoveNumber() == 1);
+  state.unmakeMove(knight);
+  CHECK(state.hash() == chess::GameState{}.hash());
+  CHECK(state.board() == chess::Board{});
+}
+
+TEST_CASE("GameState FEN") {
+  SECTION("Initial position") {
+    const chess::GameState state = chess::GameState::fromFen(chess::kStartFen);
+    CHECK(state.board() == chess::Board{});
+    CHECK(state.hash() == chess::GameState{}.hash());
+    CHECK(chess::GameState{}.toFen() == chess::kStartFen);
+  }
+  SECTION("Round trip") {
+    for (const char *fen :
+         {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R"
+          " b KQkq - 3 9",
+          "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+          "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+          "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3"}) {
+      const chess::GameState state = chess::GameState::fromFen(fen);
+      CHECK(state.toFen() == fen);
+      CHECK(state.hash() == state.computeHash());
+    }
+  }
+  SECTION("Same key as the moves that lead to it") {
+    chess::GameState state;
+    for (const auto &[from, to] :
+         {std::pair{12, 28}, std::pair{51, 35}, std::pair{28, 36},
+          std::pair{53, 37}}) {
+      (void)state.makeMove(chess::Move{chess::squareToPosition(from),
+                                       chess::squareToPosition(to)});
+    }
+    const chess::GameState fen = chess::GameState::fromFen(
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3");
+    CHECK(state.toFen() == fen.toFen());
+    CHECK(state.hash() == fen.hash());
+    CHECK(state.enPassantSquare() == 45);
+  }
+  SECTION("Unusable en passant square") {
+    // No black pawn can take on e3, so the square is dropped
+    const chess::GameState state = chess::GameState::fromFen(
+        "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1");
+    CHECK(!state.enPassantSquare());
+    CHECK(state.toFen() ==
+          "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1");
+  }
+  SECTION("Clocks may be left out") {
+    const chess::GameState state =
+        chess::GameState::fromFen("4k3/8/8/8/8/8/8/4K3 b - -");
+    CHECK(state.sideToMove() == chess::Side::kBlack);
+    CHECK(state.halfmoveClock() == 0);
+    CHECK(state.fullmoveNumber() == 1);
+  }
+  SECTION("Malformed") {
+    for (const char *fen :
+         {"", "4k3/8/8/8/8/8/8/4K3 w - - 0", "4k3/8/8/8/8/8/8/4K3 x - - 0 1",
+          "4k3/8/8/8/8/8/8/4K4 w - - 0 1", "4k3/8/8/8/8/8/8 w - - 0 1",
+          "4k3/8/8/8/8/8/8/4X3 w - - 0 1", "8/8/8/8/8/8/8/4K3 w - - 0 1",
+          "4k3/8/8/8/8/8/8/4K3 w KK - 0 1", "4k3/8/8/8/8/8/8/4K3 w - e4 0 1",
+          "4k3/8/8/8/8/8/8/4K3 w - - -1 1", "4k3/8/8/8/8/8/8/4K3 w - - 0 0",
+          // Pawns on the first or last row
+          "P3k3/8/8/8/8/8/8/4K3 w - - 0 1", "4k3/8/8/8/8/8/8/4K2p b - - 0 1",
+          // Nine pawns, seventeen pieces
+          "4k3/8/8/8/8/P7/PPPPPPPP/4K3 w - - 0 1",
+          "4k3/8/8/8/8/N7/PPPPPPPP/RNBQKBNR w - - 0 1",
+          // No black pawn in front of e6, or the square it came from taken
+          "4k3/8/8/3P4/8/8/8/4K3 w - e6 0 1",
+          "4k3/4p3/8/3Pp3/8/8/8/4K3 w - e6 0 1"}) {
+      CHECK_THROWS_AS(chess::GameState::fromFen(fen), chess::GameException);
+    }
+  }
+}
+
+TEST_CASE("GameState copy") {
+  chess::GameState state;
+  (void)state.makeMove(
+      chess::Move{chess::Position{1, 4}, chess::Position{3, 4}});
+
+  // A plain byte copy is a complete copy of the position
+  chess::GameState copy;
+  std::memcpy(static_cast<void *>(&copy), &state, sizeof(chess::GameState));
+  CHECK(copy.hash() == state.hash());
+  CHECK(copy.board() == state.board());
+  CHECK(copy.sideToMove() == chess::Side::kBlack);
+
+  (void)copy.makeMove(
+      chess::Move{chess::Position{6, 4}, chess::Position{4, 4}});
+  CHECK(copy.hash() != state.hash());
+  CHECK(state.sideToMove() == chess::Side::kBlack);
+}
+
+#endif
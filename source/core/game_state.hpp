@@ -0,0 +1,105 @@
+#pragma once
+
+#include "chess.hpp"
+#include "move.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace chess {
+/// The initial position in Forsyth-Edwards Notation
+inline constexpr std::string_view kStartFen =
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+/// @brief Everything that defines a position and nothing more: the board,
+///  the side to move, castling rights, the en passant square, the move
+///  clocks and the Zobrist key.
+///
+/// It is trivially copyable, so a search node or a worker thread can take a
+/// position with a single memcpy. Game keeps the move history, the captured
+/// pieces and the attack caches around one.
+class GameState {
+public:
+  /// What makeMove() changed, for unmakeMove() to revert
+  struct Undo {
+    Move move;
+    /// The piece that moved, as it was before a promotion
+    PieceWithSide moved;
+    SquareState captured;
+    /// The destination, except for en passant captures
+    Position capturedSquare;
+    CastlingRights castlingRights = kNoCastlingRights;
+    std::optional<int> enPassantSquare;
+    int halfmoveClock = 0;
+    /// Every square whose content the move changed
+    Bitboard changed = kEmptyBitboard;
+  };
+
+  /// The initial position, white to move.
+  GameState();
+
+  /// @brief Reads the position from Forsyth-Edwards Notation, e.g.
+  ///  kStartFen. The two move clocks may be left out.
+  ///
+  /// An en passant square is only kept when a pawn can capture on it, as
+  /// makeMove() does.
+  /// @throws GameException if @a fen is malformed.
+  [[nodiscard]] static GameState fromFen(std::string_view fen);
+
+  /// @return The position in Forsyth-Edwards Notation.
+  [[nodiscard]] std::string toFen() const;
+
+  /// @brief Plays @a move, which must be legal in this position.
+  /// @return What unmakeMove() needs to take it back.
+  Undo makeMove(Move move);
+
+  /// Takes back the move that returned @a undo, which must be the last one.
+  void unmakeMove(const Undo &undo);
+
+  [[nodiscard]] const Board &board() const;
+
+  [[nodiscard]] Side sideToMove() const;
+
+  /// @return The castlings still allowed, see castlingRight().
+  [[nodiscard]] CastlingRights castlingRights() const;
+
+  [[nodiscard]] bool castlingAllowed(BoardSide board_side, Side side) const;
+
+  /// @return The square behind the pawn that can be captured en passant on
+  ///  this move, where the capturing pawn lands, if any.
+  [[nodiscard]] std::optional<int> enPassantSquare() const;
+
+  /// @return The moves played since the last capture or pawn move.
+  [[nodiscard]] int halfmoveClock() const;
+
+  /// @return The number of the current move, starting at 1 and growing
+  ///  after every black move.
+  [[nodiscard]] int fullmoveNumber() const;
+
+  /// @return The Zobrist key of the position. It covers the pieces, the side
+  ///  to move, the castling rights and the en passant file, and is updated
+  ///  incrementally by makeMove and unmakeMove.
+  [[nodiscard]] std::uint64_t hash() const;
+
+  /// @return The position key recomputed from scratch.
+  [[nodiscard]] std::uint64_t computeHash() const;
+
+private:
+  void changeTurns();
+
+  void setCastlingRights(CastlingRights rights);
+
+  void setEnPassantSquare(std::optional<int> square);
+
+  Board mBoard;
+  Side mSideToMove = Side::kWhite;
+  CastlingRights mCastlingRights = kAllCastlingRights;
+  std::optional<int> mEnPassantSquare;
+  int mHalfmoveClock = 0;
+  int mFullmoveNumber = 1;
+  // Zobrist key of everything but the pieces, which Board keys itself
+  std::uint64_t mStateHash = 0;
+};
+} // namespace chess
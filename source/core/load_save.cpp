@@ -1,36 +1,111 @@
 #include "load_save.hpp"
 #include "game.hpp"
+#include "game_archive.hpp"
+#include "pgn.hpp"
 #include "user_interface.hpp"
 #include "validation.hpp"
 
 #include <chrono>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <string>
 
 namespace chess {
+namespace {
+/// @return @a file_name, with ".dat" added when it has no extension.
+std::filesystem::path withDefaultExtension(const std::string &file_name) {
+  std::filesystem::path file{file_name};
+  if (!file.has_extension()) {
+    file += ".dat";
+  }
+  return file;
+}
+
+/// @brief Plays @a text, one move of a text game such as "E2-E4" or
+///  "E7-E8=Q", in @a game.
+/// @return Why the move could not be played, or an empty string if it was.
+std::string playSavedMove(Game &game, const std::string &text) {
+  const bool has_promotion = text.size() == 7 && text[5] == '=';
+  if ((text.size() != 5 && !has_promotion) || text[2] != '-') {
+    return "invalid move " + text;
+  }
+  const auto [from, to] = parseMove(text);
+  if (!validBoardPosition(from) || !validBoardPosition(to)) {
+    return "invalid move " + text;
+  }
+
+  // Promotions are logged with a capital letter, older files may differ
+  Piece promotion = Piece::kQueen;
+  if (has_promotion) {
+    if (std::string_view{"QRBNqrbn"}.find(text[6]) == std::string_view::npos) {
+      return "invalid promotion " + text;
+    }
+    promotion = charToPiece(text[6]).mPiece;
+  }
+
+  const MoveValidation validation =
+      validateMove(game, Move{from, to, MoveFlag::kPromotion, promotion});
+  if (!validation.valid()) {
+    return "illegal move " + text + " (" +
+           std::string{describe(validation.error)} + ")";
+  }
+  game.playMove(validation.move);
+  return "";
+}
+} // namespace
+
 void saveGame(const chess::Game &current_game) {
   std::string file_name;
-  std::cout << "Type file name to be saved (no extension): ";
+  std::cout << "Type file name to be saved (" << kArchiveExtension
+            << " for a game archive, no extension for text): ";
 
   getline(std::cin, file_name);
-  file_name += ".dat";
+  saveGame(current_game, withDefaultExtension(file_name));
+}
+
+void saveGame(const chess::Game &current_game,
+              const std::filesystem::path &file) {
+  if (file.extension() == kArchiveExtension) {
+    try {
+      ArchiveWriter writer{file};
+      writer.add(current_game);
+      writer.finish();
+      createNextMessage("Game saved as " + file.string() + "\n");
+    } catch (const GameException &err) {
+      std::cout << "Error creating file! Save failed: " << err.what() << "\n";
+    }
+    return;
+  }
 
-  std::ofstream ofs(file_name);
+  std::ofstream ofs(file);
   if (ofs.is_open()) {
     // Write the date and time of save operation
     auto time_now = std::chrono::system_clock::now();
     std::time_t end_time = std::chrono::system_clock::to_time_t(time_now);
     ofs << "[Chess console] Saved at: " << std::ctime(&end_time);
 
+    // A game set up from a position says where it started
+    if (const std::string fen = current_game.initialState().toFen();
+        fen != kStartFen) {
+      ofs << "[FEN \"" << fen << "\"]\n";
+    }
+
     // Write the moves
     for (unsigned i = 0; i < current_game.rounds.size(); i++) {
-      ofs << current_game.rounds[i].white_move.c_str() << " | "
-          << current_game.rounds[i].black_move.c_str() << "\n";
+      // Padded so that the columns line up with promotions, e.g. "E7-E8=Q"
+      const chess::Game::Round &round = current_game.rounds[i];
+      ofs << std::left << std::setw(7)
+          << (round.white_move ? toString(*round.white_move) : "...")
+          << " | ";
+      if (round.black_move) {
+        ofs << std::setw(7) << toString(*round.black_move);
+      }
+      ofs << "\n";
     }
 
     ofs.close();
-    createNextMessage("Game saved as " + file_name + "\n");
+    createNextMessage("Game saved as " + file.string() + "\n");
   } else {
     std::cout << "Error creating file! Save failed\n";
   }
@@ -40,103 +115,110 @@ void saveGame(const chess::Game &current_game) {
 
 chess::Game loadGame() {
   std::string file_name;
-  std::cout << "Type file name to be loaded (no extension): ";
+  std::cout << "Type file name to be loaded (" << kArchiveExtension
+            << " for a game archive, no extension for text): ";
   getline(std::cin, file_name);
-  file_name += ".dat";
-  return loadGame(file_name);
+  return loadGame(withDefaultExtension(file_name));
 }
 
-chess::Game loadGame(const std::filesystem::path &file) {
+LoadedGame readGame(const std::filesystem::path &file) {
+  LoadedGame loaded;
+  try {
+    if (file.extension() == ".pgn") {
+      const MappedFile mapped{file};
+      const std::vector<std::string_view> games =
+          splitPgnGames(mapped.text());
+      if (games.empty()) {
+        throw GameException("the file holds no game");
+      }
+      const PgnGame game = parsePgnGame(games.front());
+      loaded.game = game.replay();
+      loaded.error = game.error;
+      return loaded;
+    }
+    if (file.extension() == kArchiveExtension) {
+      const GameArchive archive{file};
+      if (archive.size() == 0) {
+        throw GameException("the file holds no game");
+      }
+      loaded.game = archive[0].replay();
+      return loaded;
+    }
+  } catch (const GameException &err) {
+    loaded.error = err.what();
+    return loaded;
+  }
+
   std::ifstream ifs(file);
-  if (ifs) {
-    // First, reset the pieces
-    auto current_game = chess::Game{};
-
-    // Now, read the lines from the file and then make the moves
-    std::string line;
-    while (std::getline(ifs, line)) {
-      // Skip lines that starts with "[]"
-      if (0 == line.compare(0, 1, "[")) {
-        continue;
+  if (!ifs) {
+    loaded.error = "the file can not be opened";
+    return loaded;
+  }
+
+  // Read the lines from the file and make the moves
+  std::string line;
+  int line_number = 0;
+  while (std::getline(ifs, line)) {
+    line_number++;
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+
+    // A position to start from instead of the initial one
+    if (0 == line.compare(0, 6, "[FEN \"")) {
+      const std::size_t end = line.rfind('"');
+      try {
+        loaded.game =
+            Game::fromFen(std::string_view{line}.substr(6, end - 6));
+      } catch (const GameException &err) {
+        loaded.error = "invalid FEN line: " + std::string{err.what()};
+        return loaded;
       }
+      continue;
+    }
+
+    // Skip lines that starts with "[]"
+    if (0 == line.compare(0, 1, "[")) {
+      continue;
+    }
+
+    // There might be one or two moves in the line, "E2-E4   | E7-E5"
+    std::array<std::string, 2> loaded_move;
+    const std::size_t separator = line.find('|');
+    loaded_move[0] = line.substr(0, separator);
+    if (separator != std::string::npos) {
+      loaded_move[1] = line.substr(separator + 1);
+    }
 
-      // There might be one or two moves in the line
-      std::array<std::string, 2> loaded_move;
-
-      // Find the separator and subtract one
-      std::size_t separator = line.find(" |");
-
-      // For the first move, read from the beginning of the std::string until
-      // the separator
-      loaded_move[0] = line.substr(0, separator);
-
-      // For the second move, read from the separator until the end of the
-      // std::string (omit second parameter)
-      loaded_move[1] = line.substr(line.find("|") + 2);
-
-      for (int i = 0; i < 2 && loaded_move[i] != ""; i++) {
-        const auto [from, to, promoted] =
-            current_game.parseMoveWithPromotion(loaded_move[i]);
-
-        // Check if line is valid
-        if (from.iColumn < 0 || from.iColumn > 7 || from.iRow < 0 ||
-            from.iRow > 7 || to.iColumn < 0 || to.iColumn > 7 || to.iRow < 0 ||
-            to.iRow > 7) {
-          createNextMessage("[Invalid] Can't load this game because there are "
-                            "invalid lines!\n");
-          return chess::Game{};
-        }
-
-        // Is that move allowed? (should be because we already validated before
-        // saving)
-        chess::EnPassant S_enPassant = {0};
-        chess::Castling S_castling = {0};
-        chess::Promotion S_promotion = {0};
-
-        if (!isMoveValid(current_game, from, to, S_enPassant, S_castling,
-                         S_promotion)) {
-          createNextMessage("[Invalid] Can't load this game because there are "
-                            "invalid moves!\n");
-          return chess::Game{};
-        }
-
-        // ---------------------------------------------------
-        // A promotion occurred
-        // ---------------------------------------------------
-        if (S_promotion.bApplied && promoted) {
-          if (promoted->mPiece != Piece::kQueen &&
-              promoted->mPiece != Piece::kRook &&
-              promoted->mPiece != Piece::kKnight &&
-              promoted->mPiece != Piece::kBishop) {
-            createNextMessage("[Invalid] Can't load this game because there is "
-                              "an invalid promotion!\n");
-            return chess::Game{};
-          }
-
-          S_promotion.chBefore = *current_game.getPieceAtPosition(from);
-
-          if (chess::Side::kWhite == current_game.getCurrentTurn()) {
-            S_promotion.chAfter = *promoted;
-          } else {
-            S_promotion.chAfter = *promoted;
-          }
-        }
-
-        // Log the move
-        current_game.logMove(loaded_move[i]);
-
-        // Make the move
-        makeTheMove(current_game, from, to, S_enPassant, S_castling,
-                    S_promotion);
+    for (std::string &text : loaded_move) {
+      // Drop the padding that lines up the columns
+      text.erase(text.find_last_not_of(' ') + 1);
+      text.erase(0, text.find_first_not_of(' '));
+
+      // No white move in the first round of a game set up with black to
+      // move
+      if (text.empty() || text == "...") {
+        continue;
+      }
+      if (const std::string error = playSavedMove(loaded.game, text);
+          !error.empty()) {
+        loaded.error = "line " + std::to_string(line_number) + ": " + error;
+        return loaded;
       }
     }
-    // Extra line after the user input
-    createNextMessage("Game loaded from " + file.string() + "\n");
-    return current_game;
-  } else {
-    createNextMessage("Error loading " + file.string() +
+  }
+  return loaded;
+}
+
+chess::Game loadGame(const std::filesystem::path &file) {
+  LoadedGame loaded = readGame(file);
+  if (!loaded.error.empty()) {
+    createNextMessage("Error loading " + file.string() + ": " + loaded.error +
                       ". Creating a new game instead\n");
     return chess::Game{};
   }
+  // Extra line after the user input
+  createNextMessage("Game loaded from " + file.string() + "\n");
+  return std::move(loaded.game);
 }
 } // namespace chess
\ No newline at end of file
@@ -1,12 +1,38 @@
 #pragma once
 
+#include "game.hpp"
+
 #include <filesystem>
+#include <string>
 
 namespace chess {
-class Game;
 
 void saveGame(const chess::Game &current_game);
+
+/// Saves @a current_game as a game archive if @a file has the
+/// kArchiveExtension, otherwise as text.
+void saveGame(const chess::Game &current_game,
+              const std::filesystem::path &file);
+
 chess::Game loadGame();
+
+/// Loads the text game in @a file, or the first game of a game archive or
+/// of a PGN file.
 chess::Game loadGame(const std::filesystem::path &file);
 
+/// A game read by readGame()
+struct LoadedGame {
+  /// The moves read before the first one that could not be played
+  chess::Game game;
+  /// Why the game could not be read to the end, empty if it was
+  std::string error;
+};
+
+/// @brief Reads @a file like loadGame(const std::filesystem::path &), but
+///  reports the first problem instead of starting a new game.
+///
+/// Nothing is shown to the user, so several files can be read at once on
+/// different threads.
+[[nodiscard]] LoadedGame readGame(const std::filesystem::path &file);
+
 } // namespace chess
\ No newline at end of file
@@ -1,8 +1,7 @@
 #include "logic.hpp"
+#include "attacks.hpp"
 
-#include <algorithm>
 #include <cassert>
-#include <ranges>
 
 namespace chess {
 namespace {
@@ -27,216 +26,133 @@ bool isKingInCheck(const Board &board, Side side,
       intended_move.has_value() && Piece::kKing == intended_move->piece.mPiece
           ? intended_move->to
           : findKing(board, side);
+  if (kingAttacks(positionToSquare(king)) &
+      board.pieces(Piece::kKing, opponentSide(side))) {
+    return true;
+  }
   const UnderAttack king_attacked =
       underAttack(king, side, board, intended_move);
   return king_attacked.bUnderAttack;
 }
 
+bool isSquareAttacked(const Board &board, const int square,
+                      const Side attacking_side) {
+  return isSquareAttacked(board, square, attacking_side, board.occupied());
+}
+
+bool isSquareAttacked(const Board &board, const int square,
+                      const Side attacking_side, const Bitboard occupied) {
+  const Bitboard queens = board.pieces(Piece::kQueen, attacking_side);
+  return (pawnAttacks(opponentSide(attacking_side), square) &
+          board.pieces(Piece::kPawn, attacking_side)) ||
+         (knightAttacks(square) &
+          board.pieces(Piece::kKnight, attacking_side)) ||
+         (kingAttacks(square) & board.pieces(Piece::kKing, attacking_side)) ||
+         (bishopAttacks(square, occupied) &
+          (board.pieces(Piece::kBishop, attacking_side) | queens)) ||
+         (rookAttacks(square, occupied) &
+          (board.pieces(Piece::kRook, attacking_side) | queens));
+}
+
 UnderAttack underAttack(const Position pos, const Side side, const Board &board,
                         const std::optional<IntendedMove> &intended_move) {
-  UnderAttack attack;
-  // a) Direction: HORIZONTAL
-  // Check to left
-  if (pos.iColumn > 0) {
-    const auto leftIndexer = [pos](const int j) {
-      return Position{pos.iRow, pos.iColumn - j};
-    };
-    for (const int j : std::views::iota(1, pos.iColumn + 1) |
-                           std::views::drop_while(emptySquareFunctor(
-                               leftIndexer, board, intended_move))) {
-      const Position checkPos = leftIndexer(j);
-      const SquareState chPieceFound =
-          board.getPieceConsiderMove(checkPos, intended_move);
-      if (side != getPieceSide(chPieceFound.value()) &&
-          (chPieceFound->mPiece == Piece::kQueen ||
-           chPieceFound->mPiece == Piece::kRook)) {
-        updateAttack(attack, checkPos, Direction::HORIZONTAL);
+  const Side opponent = opponentSide(side);
+  Bitboard occupied = board.occupied();
+  Bitboard straight = board.pieces(Piece::kRook, opponent) |
+                      board.pieces(Piece::kQueen, opponent);
+  Bitboard diagonal = board.pieces(Piece::kBishop, opponent) |
+                      board.pieces(Piece::kQueen, opponent);
+  Bitboard knights = board.pieces(Piece::kKnight, opponent);
+  Bitboard pawns = board.pieces(Piece::kPawn, opponent);
+
+  if (intended_move) {
+    // Consider the move as made: the origin is empty and the destination
+    // holds the moving piece, whatever was there before
+    const Bitboard from = positionBit(intended_move->from);
+    const Bitboard to = intended_move->from == intended_move->to
+                            ? kEmptyBitboard
+                            : positionBit(intended_move->to);
+    occupied = (occupied & ~from) | to;
+    straight &= ~(from | to);
+    diagonal &= ~(from | to);
+    knights &= ~(from | to);
+    pawns &= ~(from | to);
+    if (intended_move->piece.mSide == opponent) {
+      switch (intended_move->piece.mPiece) {
+      case Piece::kRook:
+        straight |= to;
+        break;
+      case Piece::kBishop:
+        diagonal |= to;
+        break;
+      case Piece::kQueen:
+        straight |= to;
+        diagonal |= to;
+        break;
+      case Piece::kKnight:
+        knights |= to;
+        break;
+      case Piece::kPawn:
+        pawns |= to;
+        break;
+      case Piece::kKing:
+        break;
       }
-      break;
     }
   }
-  // Check to right
-  if (pos.iColumn < kNumCols - 1) {
-    const auto rightIndexer = [pos](const int j) {
-      return Position{pos.iRow, pos.iColumn + j};
-    };
-    for (const int j : std::views::iota(1, kNumCols - pos.iColumn) |
-                           std::views::drop_while(emptySquareFunctor(
-                               rightIndexer, board, intended_move))) {
-      const Position checkPos = rightIndexer(j);
-      const SquareState chPieceFound =
-          board.getPieceConsiderMove(checkPos, intended_move);
-      if (side != getPieceSide(chPieceFound.value()) &&
-          (chPieceFound->mPiece == Piece::kQueen ||
-           chPieceFound->mPiece == Piece::kRook)) {
-        updateAttack(attack, checkPos, Direction::HORIZONTAL);
-      }
-      break;
-    }
-  }
-  // b) Direction: VERTICAL
-  // check below
-  if (pos.iRow > 0) {
-    const auto downIndexer = [pos](const int i) {
-      return Position{pos.iRow - i, pos.iColumn};
-    };
-    for (const int i : std::views::iota(1, pos.iRow + 1) |
-                           std::views::drop_while(emptySquareFunctor(
-                               downIndexer, board, intended_move))) {
-      const Position checkPos = downIndexer(i);
-      const SquareState chPieceFound =
-          board.getPieceConsiderMove(checkPos, intended_move);
-      if (side != getPieceSide(chPieceFound.value()) &&
-          (chPieceFound->mPiece == Piece::kQueen ||
-           chPieceFound->mPiece == Piece::kRook)) {
-        updateAttack(attack, checkPos, Direction::VERTICAL);
-      }
-      break;
-    }
-  }
-  // Check above
-  if (pos.iRow < kNumRows - 1) {
-    const auto upIndexer = [pos](const int i) {
-      return Position{pos.iRow + i, pos.iColumn};
-    };
-    for (const int i : std::views::iota(1, kNumRows - pos.iRow) |
-                           std::views::drop_while(emptySquareFunctor(
-                               upIndexer, board, intended_move))) {
-      const Position checkPos = upIndexer(i);
-      const SquareState chPieceFound =
-          board.getPieceConsiderMove(checkPos, intended_move);
-      if (side != getPieceSide(chPieceFound.value()) &&
-          (chPieceFound->mPiece == Piece::kQueen ||
-           chPieceFound->mPiece == Piece::kRook)) {
-        updateAttack(attack, checkPos, Direction::VERTICAL);
-      }
-      break;
-    }
-  }
-  // c) Direction: DIAGONAL
-  // Check the diagonal up-right
-  if (pos.iRow < kNumRows - 1 && pos.iColumn < kNumCols - 1) {
-    const auto upRightIndexer = [pos](const int i) {
-      return Position{pos.iRow + i, pos.iColumn + i};
-    };
-    for (const int i : std::views::iota(1, std::min(kNumRows - pos.iRow,
-                                                    kNumCols - pos.iColumn)) |
-                           std::views::drop_while(emptySquareFunctor(
-                               upRightIndexer, board, intended_move))) {
-      const Position checkPos = upRightIndexer(i);
-      const SquareState chPieceFound =
-          board.getPieceConsiderMove(checkPos, intended_move);
-      const auto isValidPawn = [chPieceFound, pos,
-                                side](const Position checkPos) {
-        return (chPieceFound->mPiece == Piece::kPawn) &&
-               (checkPos.iRow == pos.iRow + 1) &&
-               (checkPos.iColumn == pos.iColumn + 1) && (side == Side::kWhite);
-      };
-      if (side != getPieceSide(chPieceFound.value()) &&
-          (isValidPawn(checkPos) || chPieceFound->mPiece == Piece::kQueen ||
-           chPieceFound->mPiece == Piece::kBishop)) {
-        updateAttack(attack, checkPos, Direction::DIAGONAL);
-      }
-      break;
-    }
-  }
-  // Check the diagonal up-left
-  if (pos.iRow < kNumRows - 1 && pos.iColumn > 0) {
-    const auto upLeftIndexer = [pos](const int i) {
-      return Position{pos.iRow + i, pos.iColumn - i};
-    };
-    for (const int i :
-         std::views::iota(1, std::min(kNumRows - pos.iRow, pos.iColumn + 1)) |
-             std::views::drop_while(
-                 emptySquareFunctor(upLeftIndexer, board, intended_move))) {
-      const Position checkPos = upLeftIndexer(i);
-      const SquareState chPieceFound =
-          board.getPieceConsiderMove(checkPos, intended_move);
-      const auto isValidPawn = [chPieceFound, pos,
-                                side](const Position checkPos) {
-        return (chPieceFound->mPiece == Piece::kPawn) &&
-               (checkPos.iRow == pos.iRow + 1) &&
-               (checkPos.iColumn == pos.iColumn - 1) && (side == Side::kWhite);
-      };
-      if (side != getPieceSide(chPieceFound.value()) &&
-          (isValidPawn(checkPos) || chPieceFound->mPiece == Piece::kQueen ||
-           chPieceFound->mPiece == Piece::kBishop)) {
-        updateAttack(attack, checkPos, Direction::DIAGONAL);
-      }
-      break;
-    }
-  }
-  // Check the diagonal down-right
-  if (pos.iRow > 0 && pos.iColumn < kNumCols - 1) {
-    const auto downRightIndexer = [pos](const int i) {
-      return Position{pos.iRow - i, pos.iColumn + i};
-    };
-    for (const int i :
-         std::views::iota(1, std::min(pos.iRow + 1, kNumCols - pos.iColumn)) |
-             std::views::drop_while(
-                 emptySquareFunctor(downRightIndexer, board, intended_move))) {
-      const Position checkPos = downRightIndexer(i);
-      const SquareState chPieceFound =
-          board.getPieceConsiderMove(checkPos, intended_move);
-      const auto isValidPawn = [chPieceFound, pos,
-                                side](const Position checkPos) {
-        return (chPieceFound->mPiece == Piece::kPawn) &&
-               (checkPos.iRow == pos.iRow - 1) &&
-               (checkPos.iColumn == pos.iColumn + 1) && (side == Side::kBlack);
-      };
-      if (side != getPieceSide(chPieceFound.value()) &&
-          (isValidPawn(checkPos) || chPieceFound->mPiece == Piece::kQueen ||
-           chPieceFound->mPiece == Piece::kBishop)) {
-        updateAttack(attack, checkPos, Direction::DIAGONAL);
-      }
-      break;
+
+  // Every ray holds at most one attacker, the first piece on it. Sort them by
+  // ray so that the attackers are reported in a fixed order: left, right,
+  // below, above, then the diagonals up-right, up-left, down-right, down-left
+  const int square = positionToSquare(pos);
+  std::array<std::optional<Attacker>, 8> rays;
+  for (const int attacker :
+       BitboardSquares{(rookAttacks(square, occupied) & straight) |
+                       (bishopAttacks(square, occupied) & diagonal) |
+                       (pawnAttacks(side, square) & pawns)}) {
+    const Position attackerPos = squareToPosition(attacker);
+    const int dRow = attackerPos.iRow - pos.iRow;
+    const int dColumn = attackerPos.iColumn - pos.iColumn;
+    if (dRow == 0) {
+      rays[dColumn < 0 ? 0 : 1] = Attacker{attackerPos, Direction::HORIZONTAL};
+    } else if (dColumn == 0) {
+      rays[dRow < 0 ? 2 : 3] = Attacker{attackerPos, Direction::VERTICAL};
+    } else {
+      rays[dRow > 0 ? (dColumn > 0 ? 4 : 5) : (dColumn > 0 ? 6 : 7)] =
+          Attacker{attackerPos, Direction::DIAGONAL};
     }
   }
-  // Check the diagonal down-left
-  if (pos.iRow > 0 && pos.iColumn > 0) {
-    const auto downLeftIndexer = [pos](const int i) {
-      return Position{pos.iRow - i, pos.iColumn - i};
-    };
-    for (const int i :
-         std::views::iota(1, std::min(pos.iRow + 1, pos.iColumn + 1)) |
-             std::views::drop_while(
-                 emptySquareFunctor(downLeftIndexer, board, intended_move))) {
-      const Position checkPos = downLeftIndexer(i);
-      const SquareState chPieceFound =
-          board.getPieceConsiderMove(checkPos, intended_move);
-      const auto isValidPawn = [chPieceFound, pos,
-                                side](const Position checkPos) {
-        return (chPieceFound->mPiece == Piece::kPawn) &&
-               (checkPos.iRow == pos.iRow - 1) &&
-               (checkPos.iColumn == pos.iColumn - 1) && (side == Side::kBlack);
-      };
-      if (side != getPieceSide(chPieceFound.value()) &&
-          (isValidPawn(checkPos) || chPieceFound->mPiece == Piece::kQueen ||
-           chPieceFound->mPiece == Piece::kBishop)) {
-        updateAttack(attack, checkPos, Direction::DIAGONAL);
-      }
-      break;
+
+  UnderAttack attack;
+  for (const std::optional<Attacker> &ray : rays) {
+    if (ray) {
+      updateAttack(attack, ray->pos, ray->dir);
     }
   }
+
   // d) Direction: L_SHAPED
   // Check if the piece is put in jeopardy by a knight
-  const auto lShapedIndexer = [pos](const int i) {
-    return Position{pos.iRow + knight_moves[i].iRow,
-                    pos.iColumn + knight_moves[i].iColumn};
-  };
-  for (const int i :
-       std::views::iota(0, 8) | std::views::filter(occupiedSquareFunctor(
-                                    lShapedIndexer, board, intended_move))) {
-    const Position checkPos = lShapedIndexer(i);
-    const SquareState chPieceFound =
-        board.getPieceConsiderMove(checkPos, intended_move);
-    if (side != getPieceSide(chPieceFound.value()) &&
-        chPieceFound->mPiece == Piece::kKnight) {
-      updateAttack(attack, checkPos, Direction::L_SHAPE);
+  const Bitboard knightAttackers = knightAttacks(square) & knights;
+  if (knightAttackers) {
+    for (const Position step : knight_moves) {
+      const Position checkPos{pos.iRow + step.iRow,
+                              pos.iColumn + step.iColumn};
+      if (validBoardPosition(checkPos) &&
+          (knightAttackers & positionBit(checkPos))) {
+        updateAttack(attack, checkPos, Direction::L_SHAPE);
+      }
     }
   }
   return attack;
 }
+
+UnderAttack underAttack(const Position pos, const Side side, const Board &board,
+                        const AttackMap &attacks) {
+  if (!attacks.isAttacked(pos, opponentSide(side))) {
+    return UnderAttack{};
+  }
+  return underAttack(pos, side, board);
+}
 } // namespace chess
 
 #if defined(UNIT_TEST)
@@ -533,4 +449,31 @@ TEST_CASE("logic underAttack black pawn on edge") {
   }
 }
 
+TEST_CASE("logic isKingInCheck next to the other king") {
+  using namespace chess::pieces;
+  // clang-format off
+  constexpr chess::Board::BoardArray position{
+    E, E, E, E, E, E, E, E,
+    E, E, E, E, K, E, E, E,
+    E, E, E, E, E, E, E, E,
+    E, E, E, E, k, E, E, E,
+    E, E, E, E, E, E, E, E,
+    E, E, E, E, E, E, E, E,
+    E, E, E, E, E, E, E, E,
+    E, E, E, E, E, E, E, E};
+  // clang-format on
+  const chess::Board board{position};
+  CHECK(!chess::isKingInCheck(board, chess::Side::kWhite, std::nullopt));
+  const auto kingUp = chess::IntendedMove{.piece = K, .from = {1, 4},
+                                          .to = {2, 4}};
+  CHECK(chess::isKingInCheck(board, chess::Side::kWhite, kingUp));
+  const auto kingAside = chess::IntendedMove{.piece = K, .from = {1, 4},
+                                             .to = {1, 5}};
+  CHECK(!chess::isKingInCheck(board, chess::Side::kWhite, kingAside));
+
+  CHECK(chess::isSquareAttacked(board, 20, chess::Side::kBlack));
+  CHECK(chess::isSquareAttacked(board, 20, chess::Side::kWhite));
+  CHECK(!chess::isSquareAttacked(board, 4, chess::Side::kBlack));
+}
+
 #endif
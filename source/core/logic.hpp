@@ -1,5 +1,6 @@
 #pragma once
 
+#include "attack_map.hpp"
 #include "board.hpp"
 #include "chess.hpp"
 
@@ -8,7 +9,8 @@
 namespace chess {
 
 /// Checks if the king of side @a side is in check, considering the move
-/// @a intended_move.
+/// @a intended_move. Unlike underAttack, the opponent king counts as an
+/// attacker, so that kings cannot move next to each other.
 bool isKingInCheck(const Board &board, Side side,
                    const std::optional<IntendedMove> &intended_move);
 
@@ -19,23 +21,18 @@ UnderAttack
 underAttack(Position pos, Side side, const Board &board,
             const std::optional<IntendedMove> &intended_move = std::nullopt);
 
-template <typename Indexer>
-auto emptySquareFunctor(const Indexer &indexer, const Board &board,
-                        const std::optional<IntendedMove> &intended_move) {
-  return [indexer, &board, intended_move](const int index) {
-    return !board.getPieceConsiderMove(indexer(index), intended_move)
-                .has_value();
-  };
-}
-
-template <typename Indexer>
-auto occupiedSquareFunctor(const Indexer &indexer, const Board &board,
-                           const std::optional<IntendedMove> &intended_move) {
-  return [indexer, &board, intended_move](const int index) {
-    const Position pos = indexer(index);
-    return validBoardPosition(pos) &&
-           board.getPieceConsiderMove(pos, intended_move).has_value();
-  };
-}
+/// @return True if any piece of side @a attacking_side, king included,
+///  attacks the linear square @a square on @a board.
+bool isSquareAttacked(const Board &board, int square, Side attacking_side);
+
+/// Same as above, with the sliders seeing the board as @a occupied. Used to
+/// test a king's destination with the king itself taken off the board.
+bool isSquareAttacked(const Board &board, int square, Side attacking_side,
+                      Bitboard occupied);
+
+/// Same as underAttack without an intended move, but returns early when
+/// @a attacks shows that no opponent piece attacks @a pos.
+UnderAttack underAttack(Position pos, Side side, const Board &board,
+                        const AttackMap &attacks);
 
 } // namespace chess
@@ -0,0 +1,84 @@
+#include "mapped_file.hpp"
+#include "game.hpp"
+
+#include <utility>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace chess {
+MappedFile::MappedFile(const std::filesystem::path &file) {
+#if defined(_WIN32)
+  std::ifstream ifs(file, std::ios::binary);
+  if (!ifs) {
+    throw GameException("Can't open " + file.string());
+  }
+  mBuffer.resize(std::filesystem::file_size(file));
+  ifs.read(reinterpret_cast<char *>(mBuffer.data()),
+           static_cast<std::streamsize>(mBuffer.size()));
+  mData = mBuffer.data();
+  mSize = mBuffer.size();
+#else
+  const int fd = ::open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw GameException("Can't open " + file.string());
+  }
+  struct stat status {};
+  if (::fstat(fd, &status) != 0) {
+    ::close(fd);
+    throw GameException("Can't read the size of " + file.string());
+  }
+  mSize = static_cast<std::size_t>(status.st_size);
+  // An empty file can not be mapped, and needs no mapping either
+  if (mSize > 0) {
+    void *const data = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      ::close(fd);
+      throw GameException("Can't map " + file.string());
+    }
+    mData = static_cast<const std::byte *>(data);
+  }
+  // The mapping stays valid once the descriptor is closed
+  ::close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() { unmap(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : mData(std::exchange(other.mData, nullptr)),
+      mSize(std::exchange(other.mSize, 0)),
+      mBuffer(std::move(other.mBuffer)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    unmap();
+    mData = std::exchange(other.mData, nullptr);
+    mSize = std::exchange(other.mSize, 0);
+    mBuffer = std::move(other.mBuffer);
+  }
+  return *this;
+}
+
+std::span<const std::byte> MappedFile::bytes() const { return {mData, mSize}; }
+
+std::string_view MappedFile::text() const {
+  return {reinterpret_cast<const char *>(mData), mSize};
+}
+
+void MappedFile::unmap() {
+#if !defined(_WIN32)
+  if (mData != nullptr) {
+    ::munmap(const_cast<std::byte *>(mData), mSize);
+  }
+#endif
+  mData = nullptr;
+  mSize = 0;
+}
+} // namespace chess
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace chess {
+/// @brief A file mapped read-only into memory for as long as the object
+///  lives, so its bytes are read in place rather than copied.
+///
+/// Where mmap is not available the file is read into a buffer instead.
+class MappedFile {
+public:
+  /// @throws GameException if @a file can not be opened or mapped.
+  explicit MappedFile(const std::filesystem::path &file);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  [[nodiscard]] std::span<const std::byte> bytes() const;
+
+  /// @return The bytes of the file seen as text.
+  [[nodiscard]] std::string_view text() const;
+
+private:
+  void unmap();
+
+  const std::byte *mData = nullptr;
+  std::size_t mSize = 0;
+  // Only used without mmap
+  std::vector<std::byte> mBuffer;
+};
+} // namespace chess
@@ -0,0 +1,59 @@
+#include "move.hpp"
+
+namespace chess {
+
+std::string toString(const Move &move) {
+  std::string text;
+  for (const Position pos : {move.from(), move.to()}) {
+    if (!text.empty()) {
+      text += '-';
+    }
+    text += static_cast<char>('A' + pos.iColumn);
+    text += static_cast<char>('1' + pos.iRow);
+  }
+  if (move.flag() == MoveFlag::kPromotion) {
+    // Always with a capital letter, whatever the side
+    text += '=';
+    text += pieceToChar({move.promotion(), Side::kWhite});
+  }
+  return text;
+}
+
+} // namespace chess
+
+#if defined(UNIT_TEST)
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Move encoding") {
+  const chess::Position e7{.iRow = 6, .iColumn = 4};
+  const chess::Position e8{.iRow = 7, .iColumn = 4};
+
+  const chess::Move quiet{e7, e8};
+  CHECK(quiet.from() == e7);
+  CHECK(quiet.to() == e8);
+  CHECK(quiet.fromSquare() == 52);
+  CHECK(quiet.toSquare() == 60);
+  CHECK(quiet.flag() == chess::MoveFlag::kNormal);
+  CHECK(chess::toString(quiet) == "E7-E8");
+
+  for (const chess::Piece piece : {chess::Piece::kQueen, chess::Piece::kRook,
+                                   chess::Piece::kBishop,
+                                   chess::Piece::kKnight}) {
+    const chess::Move promotion{e7, e8, chess::MoveFlag::kPromotion, piece};
+    CHECK(promotion.from() == e7);
+    CHECK(promotion.to() == e8);
+    CHECK(promotion.flag() == chess::MoveFlag::kPromotion);
+    CHECK(promotion.promotion() == piece);
+    CHECK(promotion != quiet);
+  }
+  CHECK(chess::toString(chess::Move{e7, e8, chess::MoveFlag::kPromotion,
+                                    chess::Piece::kKnight}) == "E7-E8=N");
+
+  const chess::Move castling{chess::Position{0, 4}, chess::Position{0, 6},
+                             chess::MoveFlag::kCastling};
+  CHECK(castling.flag() == chess::MoveFlag::kCastling);
+  CHECK(chess::toString(castling) == "E1-G1");
+}
+
+#endif
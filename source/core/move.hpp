@@ -0,0 +1,136 @@
+#pragma once
+
+#include "board.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <string>
+
+namespace chess {
+/// What a move does besides taking the piece from one square to another
+enum struct MoveFlag : std::uint8_t {
+  kNormal,
+  kEnPassant,
+  kCastling,
+  kPromotion
+};
+
+/// @brief A move packed into 16 bits: the origin and destination squares,
+///  the MoveFlag and the promotion piece.
+///
+/// Bits 0-5 hold the origin square, 6-11 the destination, 12-13 the flag and
+/// 14-15 the promotion piece. Text is only made from it with toString().
+class Move {
+public:
+  constexpr Move() = default;
+
+  /// @param promotion Only kept for MoveFlag::kPromotion; one of queen, rook,
+  ///  bishop or knight.
+  constexpr Move(const Position from, const Position to,
+                 const MoveFlag flag = MoveFlag::kNormal,
+                 const Piece promotion = Piece::kQueen)
+      : mData(static_cast<std::uint16_t>(
+            positionToSquare(from) | positionToSquare(to) << kToShift |
+            static_cast<int>(flag) << kFlagShift |
+            promotionCode(flag == MoveFlag::kPromotion ? promotion
+                                                       : Piece::kQueen)
+                << kPromotionShift)) {}
+
+  [[nodiscard]] constexpr int fromSquare() const { return mData & kSquareMask; }
+  [[nodiscard]] constexpr int toSquare() const {
+    return (mData >> kToShift) & kSquareMask;
+  }
+  [[nodiscard]] constexpr Position from() const {
+    return squareToPosition(fromSquare());
+  }
+  [[nodiscard]] constexpr Position to() const {
+    return squareToPosition(toSquare());
+  }
+  [[nodiscard]] constexpr MoveFlag flag() const {
+    return static_cast<MoveFlag>((mData >> kFlagShift) & 0x3);
+  }
+  /// @return The piece a pawn turns into, only meaningful for
+  ///  MoveFlag::kPromotion.
+  [[nodiscard]] constexpr Piece promotion() const {
+    return kPromotionPieces[(mData >> kPromotionShift) & 0x3];
+  }
+
+  constexpr bool operator==(const Move &) const = default;
+
+  /// @return The 16 bits the move is packed into, e.g. to store it.
+  [[nodiscard]] constexpr std::uint16_t bits() const { return mData; }
+
+  /// @return The move packed into @a bits by bits().
+  [[nodiscard]] static constexpr Move fromBits(const std::uint16_t bits) {
+    Move move;
+    move.mData = bits;
+    return move;
+  }
+
+private:
+  static constexpr int kToShift = 6;
+  static constexpr int kFlagShift = 12;
+  static constexpr int kPromotionShift = 14;
+  static constexpr int kSquareMask = 0x3F;
+  static constexpr std::array<Piece, 4> kPromotionPieces{
+      Piece::kKnight, Piece::kBishop, Piece::kRook, Piece::kQueen};
+
+  static constexpr int promotionCode(const Piece piece) {
+    for (int code = 0; code < static_cast<int>(kPromotionPieces.size());
+         code++) {
+      if (kPromotionPieces[code] == piece) {
+        return code;
+      }
+    }
+    assert(false);
+    return 3;
+  }
+
+  std::uint16_t mData = 0;
+};
+static_assert(sizeof(Move) == 2);
+
+/// @return The move as it is logged and saved, e.g. "E2-E4" or "E7-E8=Q".
+[[nodiscard]] std::string toString(const Move &move);
+
+/// @brief A fixed-capacity list of moves, meant to live on the stack.
+///
+/// No legal chess position has more than 218 moves, so 256 is always enough.
+class MoveList {
+public:
+  static constexpr int kCapacity = 256;
+
+  void push(const Move &move) {
+    assert(mSize < kCapacity);
+    mMoves[mSize++] = move;
+  }
+
+  void clear() { mSize = 0; }
+
+  /// Keeps only the first @a size moves.
+  void truncate(const int size) {
+    assert(size <= mSize);
+    mSize = size;
+  }
+
+  [[nodiscard]] int size() const { return mSize; }
+  [[nodiscard]] bool empty() const { return mSize == 0; }
+
+  [[nodiscard]] const Move &operator[](const int index) const {
+    assert(index < mSize);
+    return mMoves[index];
+  }
+  [[nodiscard]] Move &operator[](const int index) {
+    assert(index < mSize);
+    return mMoves[index];
+  }
+
+  [[nodiscard]] const Move *begin() const { return mMoves.data(); }
+  [[nodiscard]] const Move *end() const { return mMoves.data() + mSize; }
+
+private:
+  std::array<Move, kCapacity> mMoves;
+  int mSize = 0;
+};
+} // namespace chess
@@ -0,0 +1,414 @@
+#include "movegen.hpp"
+#include "attacks.hpp"
+#include "game.hpp"
+#include "logic.hpp"
+
+namespace chess {
+namespace {
+constexpr std::array<Piece, 4> kPromotionPieces{Piece::kQueen, Piece::kRook,
+                                                Piece::kBishop, Piece::kKnight};
+
+void addMoves(const int from, const Bitboard targets, MoveList &moves) {
+  for (const int to : BitboardSquares{targets}) {
+    moves.push(Move{squareToPosition(from), squareToPosition(to)});
+  }
+}
+
+void addPawnMove(const int from, const int to, MoveList &moves) {
+  const Position destination = squareToPosition(to);
+  if (destination.iRow == 0 || destination.iRow == kNumRows - 1) {
+    for (const Piece piece : kPromotionPieces) {
+      moves.push(Move{squareToPosition(from), destination,
+                      MoveFlag::kPromotion, piece});
+    }
+  } else {
+    moves.push(Move{squareToPosition(from), destination});
+  }
+}
+
+void addPawnMoves(const GameState &state, const CheckInfo &checkInfo,
+                  const Side side, MoveList &moves) {
+  const Board &board = state.board();
+  const Bitboard occupied = board.occupied();
+  const int forward = side == Side::kWhite ? kNumCols : -kNumCols;
+  const int initialRow = side == Side::kWhite ? 1 : 6;
+
+  for (const int from : board.pieceSquares(Piece::kPawn, side)) {
+    const Bitboard allowed = checkInfo.checkMask() & checkInfo.pinRay(from);
+    const int oneAhead = from + forward;
+    if (!testSquare(occupied, oneAhead)) {
+      if (testSquare(allowed, oneAhead)) {
+        addPawnMove(from, oneAhead, moves);
+      }
+      const int twoAhead = oneAhead + forward;
+      if (from / kNumCols == initialRow && !testSquare(occupied, twoAhead) &&
+          testSquare(allowed, twoAhead)) {
+        addPawnMove(from, twoAhead, moves);
+      }
+    }
+    for (const int to : BitboardSquares{pawnAttacks(side, from) &
+                                        board.pieces(opponentSide(side)) &
+                                        allowed}) {
+      addPawnMove(from, to, moves);
+    }
+  }
+
+  if (const std::optional<int> target = state.enPassantSquare()) {
+    for (const int from :
+         BitboardSquares{pawnAttacks(opponentSide(side), *target) &
+                         board.pieces(Piece::kPawn, side)}) {
+      const Move move{squareToPosition(from), squareToPosition(*target),
+                      MoveFlag::kEnPassant};
+      if (isLegalEnPassant(board, move, side)) {
+        moves.push(move);
+      }
+    }
+  }
+}
+
+void addKingMoves(const GameState &state, const CheckInfo &checkInfo,
+                  const Side side, MoveList &moves) {
+  const Board &board = state.board();
+  const std::optional<int> king = checkInfo.kingSquare();
+  if (!king) {
+    return;
+  }
+
+  // Sliders see through the king, or it could step back along a check
+  const Side opponent = opponentSide(side);
+  const Bitboard occupied = board.occupied() & ~squareBit(*king);
+  for (const int to :
+       BitboardSquares{kingAttacks(*king) & ~board.pieces(side)}) {
+    if (!isSquareAttacked(board, to, opponent, occupied)) {
+      moves.push(Move{squareToPosition(*king), squareToPosition(to)});
+    }
+  }
+
+  // Castling
+  const int row = side == Side::kWhite ? 0 : kNumRows - 1;
+  const Position home{.iRow = row, .iColumn = 4};
+  if (positionToSquare(home) != *king ||
+      checkInfo.checkers() != kEmptyBitboard) {
+    return;
+  }
+  for (const BoardSide boardSide :
+       {BoardSide::KING_SIDE, BoardSide::QUEEN_SIDE}) {
+    if (!state.castlingAllowed(boardSide, side)) {
+      continue;
+    }
+    const int step = boardSide == BoardSide::KING_SIDE ? 1 : -1;
+    const Position rook{.iRow = row,
+                        .iColumn = boardSide == BoardSide::KING_SIDE ? 7 : 0};
+    if (board(rook) != PieceWithSide{Piece::kRook, side} ||
+        (squaresBetween(*king, positionToSquare(rook)) & board.occupied())) {
+      continue;
+    }
+
+    // The king may neither pass through nor land on an attacked square
+    const int skipped = *king + step;
+    const int destination = *king + 2 * step;
+    if (!isSquareAttacked(board, skipped, opponent) &&
+        !isSquareAttacked(board, destination, opponent)) {
+      moves.push(Move{home, squareToPosition(destination),
+                      MoveFlag::kCastling});
+    }
+  }
+}
+
+void generate(const GameState &state, const CheckInfo &checkInfo,
+              MoveList &moves) {
+  moves.clear();
+  const Board &board = state.board();
+  const Side side = state.sideToMove();
+
+  addKingMoves(state, checkInfo, side, moves);
+  if (popCount(checkInfo.checkers()) > 1) {
+    // Only the king can answer a double check
+    return;
+  }
+
+  // Every other move must resolve a check, if any, and keep pinned pieces on
+  // their pin ray
+  const Bitboard occupied = board.occupied();
+  const Bitboard targets = ~board.pieces(side) & checkInfo.checkMask();
+  addPawnMoves(state, checkInfo, side, moves);
+  for (const int from : board.pieceSquares(Piece::kKnight, side)) {
+    addMoves(from, knightAttacks(from) & targets & checkInfo.pinRay(from),
+             moves);
+  }
+  for (const int from : board.pieceSquares(Piece::kBishop, side)) {
+    addMoves(from,
+             bishopAttacks(from, occupied) & targets & checkInfo.pinRay(from),
+             moves);
+  }
+  for (const int from : board.pieceSquares(Piece::kRook, side)) {
+    addMoves(from,
+             rookAttacks(from, occupied) & targets & checkInfo.pinRay(from),
+             moves);
+  }
+  for (const int from : board.pieceSquares(Piece::kQueen, side)) {
+    addMoves(from,
+             queenAttacks(from, occupied) & targets & checkInfo.pinRay(from),
+             moves);
+  }
+}
+
+bool anyLegalMove(const GameState &state, const CheckInfo &checkInfo) {
+  const Board &board = state.board();
+  const Side side = state.sideToMove();
+  const Side opponent = opponentSide(side);
+
+  // Castling is left out: when it is legal, so is the king's step onto the
+  // square it skips
+  if (const std::optional<int> king = checkInfo.kingSquare()) {
+    const Bitboard occupied = board.occupied() & ~squareBit(*king);
+    for (const int to :
+         BitboardSquares{kingAttacks(*king) & ~board.pieces(side)}) {
+      if (!isSquareAttacked(board, to, opponent, occupied)) {
+        return true;
+      }
+    }
+  }
+  if (popCount(checkInfo.checkers()) > 1) {
+    return false;
+  }
+
+  const Bitboard occupied = board.occupied();
+  const Bitboard targets = ~board.pieces(side) & checkInfo.checkMask();
+  for (const int from : board.pieceSquares(Piece::kKnight, side)) {
+    if (knightAttacks(from) & targets & checkInfo.pinRay(from)) {
+      return true;
+    }
+  }
+  for (const int from : board.pieceSquares(Piece::kBishop, side)) {
+    if (bishopAttacks(from, occupied) & targets & checkInfo.pinRay(from)) {
+      return true;
+    }
+  }
+  for (const int from : board.pieceSquares(Piece::kRook, side)) {
+    if (rookAttacks(from, occupied) & targets & checkInfo.pinRay(from)) {
+      return true;
+    }
+  }
+  for (const int from : board.pieceSquares(Piece::kQueen, side)) {
+    if (queenAttacks(from, occupied) & targets & checkInfo.pinRay(from)) {
+      return true;
+    }
+  }
+
+  const int forward = side == Side::kWhite ? kNumCols : -kNumCols;
+  const int initialRow = side == Side::kWhite ? 1 : 6;
+  for (const int from : board.pieceSquares(Piece::kPawn, side)) {
+    const Bitboard allowed = checkInfo.checkMask() & checkInfo.pinRay(from);
+    if (pawnAttacks(side, from) & board.pieces(opponent) & allowed) {
+      return true;
+    }
+    const int oneAhead = from + forward;
+    if (testSquare(occupied, oneAhead)) {
+      continue;
+    }
+    const int twoAhead = oneAhead + forward;
+    if (testSquare(allowed, oneAhead) ||
+        (from / kNumCols == initialRow && !testSquare(occupied, twoAhead) &&
+         testSquare(allowed, twoAhead))) {
+      return true;
+    }
+  }
+
+  if (const std::optional<int> target = state.enPassantSquare()) {
+    for (const int from :
+         BitboardSquares{pawnAttacks(opponent, *target) &
+                         board.pieces(Piece::kPawn, side)}) {
+      if (isLegalEnPassant(board,
+                           Move{squareToPosition(from),
+                                squareToPosition(*target),
+                                MoveFlag::kEnPassant},
+                           side)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+} // namespace
+
+bool isLegalEnPassant(const Board &board, const Move &move, const Side side) {
+  Board after = board;
+  after.setSquare(move.to(), after(move.from()));
+  after.setSquare(move.from(), pieces::E);
+  after.setSquare({.iRow = move.from().iRow, .iColumn = move.to().iColumn},
+                  pieces::E);
+  const std::optional<int> king = after.kingSquare(side);
+  return !king || !isSquareAttacked(after, *king, opponentSide(side));
+}
+
+void generateLegalMoves(const Game &game, MoveList &moves) {
+  generate(game.state(), game.checkInfo(), moves);
+}
+
+void generateLegalMoves(const GameState &state, MoveList &moves) {
+  generate(state, CheckInfo{state.board(), state.sideToMove()}, moves);
+}
+
+bool hasLegalMove(const Game &game) {
+  return anyLegalMove(game.state(), game.checkInfo());
+}
+
+bool hasLegalMove(const GameState &state) {
+  return anyLegalMove(state, CheckInfo{state.board(), state.sideToMove()});
+}
+} // namespace chess
+
+#if defined(UNIT_TEST)
+
+#include "test_utility.hpp"
+#include "validation.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+
+namespace {
+/// Plays @a move, a generated move, through isMoveValid and Game::movePiece.
+void playGeneratedMove(chess::Game &game, const chess::Move &move) {
+  chess::EnPassant S_enPassant;
+  chess::Castling S_castling;
+  chess::Promotion S_promotion;
+  REQUIRE(chess::isMoveValid(game, move.from(), move.to(), S_enPassant,
+                             S_castling, S_promotion));
+  if (S_promotion.bApplied) {
+    S_promotion.chBefore = *game.getPieceAtPosition(move.from());
+    S_promotion.chAfter = {move.promotion(), game.getCurrentTurn()};
+  }
+  game.movePiece(move.from(), move.to(), S_enPassant, S_castling,
+                 S_promotion);
+}
+
+/// Checks that isMoveValid accepts exactly the moves the generator produces.
+void checkAgreesWithIsMoveValid(const chess::Game &game) {
+  chess::MoveList moves;
+  chess::generateLegalMoves(game, moves);
+
+  const chess::Board &board = game.board();
+  for (const int from : chess::BitboardSquares{
+           board.pieces(game.getCurrentTurn())}) {
+    for (int to = 0; to < chess::kNumPositions; ++to) {
+      if (to == from) {
+        continue;
+      }
+      const chess::Position present = chess::squareToPosition(from);
+      const chess::Position future = chess::squareToPosition(to);
+      chess::EnPassant S_enPassant;
+      chess::Castling S_castling;
+      chess::Promotion S_promotion;
+      const bool valid = chess::isMoveValid(game, present, future, S_enPassant,
+                                            S_castling, S_promotion);
+      const auto generated = std::ranges::count_if(
+          moves, [&](const chess::Move &move) {
+            return move.from() == present && move.to() == future;
+          });
+      CHECK(generated == (valid ? (S_promotion.bApplied ? 4 : 1) : 0));
+      if (valid && generated) {
+        const chess::Move &move = *std::ranges::find_if(
+            moves, [&](const chess::Move &move) {
+              return move.from() == present && move.to() == future;
+            });
+        CHECK((move.flag() == chess::MoveFlag::kEnPassant) ==
+              S_enPassant.bApplied);
+        CHECK((move.flag() == chess::MoveFlag::kCastling) ==
+              S_castling.bApplied);
+      }
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("generateLegalMoves initial board") {
+  const chess::Game game;
+  chess::MoveList moves;
+  chess::generateLegalMoves(game, moves);
+  CHECK(moves.size() == 20);
+  checkAgreesWithIsMoveValid(game);
+
+  chess::MoveList from_state;
+  chess::generateLegalMoves(chess::GameState{}, from_state);
+  CHECK(std::ranges::equal(moves, from_state));
+}
+
+TEST_CASE("generateLegalMoves agrees with isMoveValid") {
+  chess::Game game;
+  SECTION("En passant") {
+    for (const char *move : {"E2-E4", "D7-D5", "E4-E5", "F7-F5"}) {
+      chess::test::playTestMove(game, move);
+    }
+    checkAgreesWithIsMoveValid(game);
+    for (const char *move : {"A2-A3", "D5-D4", "C2-C4"}) {
+      chess::test::playTestMove(game, move);
+    }
+    checkAgreesWithIsMoveValid(game);
+    // A normal capture from the fifth row is not an en passant capture
+    chess::test::playTestMove(game, "D8-D6");
+    checkAgreesWithIsMoveValid(game);
+  }
+  SECTION("King side castling") {
+    for (const char *move :
+         {"E2-E4", "E7-E5", "G1-F3", "B8-C6", "F1-C4", "G8-F6"}) {
+      chess::test::playTestMove(game, move);
+    }
+    checkAgreesWithIsMoveValid(game);
+    chess::test::playTestMove(game, "E1-G1");
+    checkAgreesWithIsMoveValid(game);
+  }
+  SECTION("Queen side castling") {
+    for (const char *move :
+         {"D2-D4", "D7-D5", "C1-F4", "C8-F5", "D1-D3", "D8-D6"}) {
+      chess::test::playTestMove(game, move);
+    }
+    // The knight on b1 still blocks the rook
+    checkAgreesWithIsMoveValid(game);
+    chess::test::playTestMove(game, "B1-C3");
+    chess::test::playTestMove(game, "B8-C6");
+    checkAgreesWithIsMoveValid(game);
+  }
+  SECTION("Promotion") {
+    for (const char *move : {"H2-H4", "G7-G5", "H4-G5", "H7-H6", "G5-H6",
+                             "E7-E6", "H6-H7", "F8-E7"}) {
+      chess::test::playTestMove(game, move);
+    }
+    checkAgreesWithIsMoveValid(game);
+    chess::test::playTestMove(game, "H7-G8");
+    checkAgreesWithIsMoveValid(game);
+  }
+  SECTION("Random games") {
+    // Linear congruential generator, so that the games are reproducible
+    std::uint64_t state = 12345;
+    for (int ply = 0; ply < 120; ++ply) {
+      chess::MoveList moves;
+      chess::generateLegalMoves(game, moves);
+      checkAgreesWithIsMoveValid(game);
+      chess::MoveList from_state;
+      chess::generateLegalMoves(game.state(), from_state);
+      CHECK(std::ranges::equal(moves, from_state));
+      CHECK(chess::hasLegalMove(game) == !moves.empty());
+      if (moves.empty()) {
+        break;
+      }
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      playGeneratedMove(game, moves[static_cast<int>((state >> 33) %
+                                                     moves.size())]);
+    }
+  }
+  SECTION("Checkmate") {
+    for (const char *move : {"E2-E4", "F7-F6", "D2-D4", "G7-G5", "D1-H5"}) {
+      chess::test::playTestMove(game, move);
+    }
+    chess::MoveList moves;
+    chess::generateLegalMoves(game, moves);
+    CHECK(moves.empty());
+    CHECK(!chess::hasLegalMove(game));
+    CHECK(!chess::hasLegalMove(game.state()));
+    checkAgreesWithIsMoveValid(game);
+  }
+}
+
+#endif
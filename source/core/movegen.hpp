@@ -0,0 +1,32 @@
+#pragma once
+
+#include "move.hpp"
+
+namespace chess {
+class Game;
+class GameState;
+
+/// @brief Fills @a moves with every legal move of the side to move in
+///  @a game, replacing its previous contents.
+///
+/// Castling, en passant and promotions are included; a promotion appears
+/// once for each piece the pawn can become.
+void generateLegalMoves(const Game &game, MoveList &moves);
+
+/// Same as generateLegalMoves(const Game &, MoveList &), for a position
+/// copied out of a game. The checks and pins are found on the fly.
+void generateLegalMoves(const GameState &state, MoveList &moves);
+
+/// @return True if the side to move in @a game has at least one legal move.
+///  The search stops at the first one found, so nothing is listed.
+[[nodiscard]] bool hasLegalMove(const Game &game);
+
+/// Same as hasLegalMove(const Game &), for a position copied out of a game.
+[[nodiscard]] bool hasLegalMove(const GameState &state);
+
+/// @return True if the en passant capture @a move does not leave the king of
+///  @a side in check. Two pawns leave their squares at once, which the pins
+///  do not describe, so the capture is played out on a copy of the board.
+[[nodiscard]] bool isLegalEnPassant(const Board &board, const Move &move,
+                                    Side side);
+} // namespace chess
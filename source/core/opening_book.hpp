@@ -0,0 +1,65 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include "move.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace chess {
+class GameState;
+
+inline constexpr std::string_view kBookExtension = ".bin";
+
+/// @return The key of @a state in Polyglot opening books. It is made like
+///  GameState::hash() but from the fixed Polyglot random numbers, so it is
+///  the same in every program that reads those books.
+[[nodiscard]] std::uint64_t polyglotKey(const GameState &state);
+
+/// @return @a move as the 16 bits Polyglot books store: the destination file
+///  and row, the origin file and row, 3 bits each, then the promotion piece.
+///  Castling is written as the king taking its own rook, e.g. e1h1.
+[[nodiscard]] std::uint16_t toPolyglotMove(const Move &move);
+
+/// A move an opening book holds for a position
+struct BookMove {
+  Move move;
+  /// How often the move should be played relative to the other ones
+  std::uint16_t weight = 0;
+};
+
+/// @brief An opening book in the Polyglot format, mapped into memory.
+///
+/// The file is a list of 16 byte entries sorted by key: the 64 bit
+/// polyglotKey(), the 16 bit toPolyglotMove(), a 16 bit weight and 32 bits
+/// of learning data that are not used. All numbers are big endian. A
+/// position is looked up with a binary search.
+class OpeningBook {
+public:
+  /// @throws GameException if @a file can not be read or is not a book.
+  explicit OpeningBook(const std::filesystem::path &file);
+
+  /// @return The number of entries.
+  [[nodiscard]] std::size_t size() const;
+
+  /// @return The legal moves the book holds for @a state, the heaviest
+  ///  first. Entries that are not legal in @a state are left out.
+  [[nodiscard]] std::vector<BookMove> moves(const GameState &state) const;
+
+  /// @return One of moves(), each picked with a chance proportional to its
+  ///  weight, or std::nullopt if the book has none. @a random is any random
+  ///  number, e.g. from std::mt19937_64.
+  [[nodiscard]] std::optional<Move> pickMove(const GameState &state,
+                                             std::uint64_t random) const;
+
+private:
+  [[nodiscard]] std::uint64_t keyAt(std::size_t index) const;
+
+  MappedFile mFile;
+  std::size_t mSize = 0;
+};
+} // namespace chess
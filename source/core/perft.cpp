@@ -0,0 +1,242 @@
+#include "perft.hpp"
+#include "game.hpp"
+#include "movegen.hpp"
+#include "thread_count.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace chess {
+namespace {
+constexpr int kDepthBits = 8;
+constexpr std::uint64_t kDepthMask = (std::uint64_t{1} << kDepthBits) - 1;
+
+/// A subtree counted by one worker: the root move and, when replies are
+/// split, one reply to it
+struct PerftTask {
+  int root = 0;
+  Move move;
+  std::optional<Move> reply;
+  std::uint64_t nodes = 0;
+};
+std::uint64_t countNodes(Game &game, const int depth, PerftCache *cache) {
+  if (depth <= 0) {
+    return 1;
+  }
+  MoveList moves;
+  generateLegalMoves(game, moves);
+  // The leaves need not be played, only counted
+  if (depth == 1) {
+    return static_cast<std::uint64_t>(moves.size());
+  }
+  if (cache) {
+    if (const auto nodes = cache->find(game.hash(), depth)) {
+      return *nodes;
+    }
+  }
+  std::uint64_t nodes = 0;
+  for (const Move &move : moves) {
+    game.makeMove(move);
+    nodes += countNodes(game, depth - 1, cache);
+    game.unmakeMove();
+  }
+  if (cache) {
+    cache->store(game.hash(), depth, nodes);
+  }
+  return nodes;
+}
+} // namespace
+
+PerftCache::PerftCache(const std::size_t size_in_mb) {
+  const std::size_t wanted =
+      std::max<std::size_t>(size_in_mb * 1024 * 1024 / sizeof(Entry), 1);
+  std::size_t size = 1;
+  while (size * 2 <= wanted) {
+    size *= 2;
+  }
+  mEntries = std::make_unique<Entry[]>(size);
+  mMask = size - 1;
+}
+
+std::optional<std::uint64_t> PerftCache::find(const std::uint64_t key,
+                                              const int depth) const {
+  const Entry &entry = mEntries[key & mMask];
+  const std::uint64_t data = entry.data.load(std::memory_order_relaxed);
+  const std::uint64_t check = entry.check.load(std::memory_order_relaxed);
+  if ((check ^ data) != key ||
+      (data & kDepthMask) != static_cast<std::uint64_t>(depth)) {
+    return std::nullopt;
+  }
+  return data >> kDepthBits;
+}
+
+void PerftCache::store(const std::uint64_t key, const int depth,
+                       const std::uint64_t nodes) {
+  Entry &entry = mEntries[key & mMask];
+  const std::uint64_t data =
+      (nodes << kDepthBits) | static_cast<std::uint64_t>(depth);
+  entry.data.store(data, std::memory_order_relaxed);
+  entry.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+std::uint64_t perft(const Game &game, const int depth, PerftCache *cache) {
+  Game copy = game;
+  return countNodes(copy, depth, cache);
+}
+
+std::vector<PerftDivide> perftDivide(const Game &game, const int depth,
+                                     const PerftOptions &options) {
+  MoveList moves;
+  generateLegalMoves(game, moves);
+
+  std::vector<PerftTask> tasks;
+  for (int root = 0; root < moves.size(); root++) {
+    if (!options.splitReplies || depth < 2) {
+      tasks.push_back({.root = root, .move = moves[root]});
+      continue;
+    }
+    Game child = game;
+    child.makeMove(moves[root]);
+    MoveList replies;
+    generateLegalMoves(child, replies);
+    for (const Move &reply : replies) {
+      tasks.push_back({.root = root, .move = moves[root], .reply = reply});
+    }
+  }
+
+  std::atomic<std::size_t> next_task{0};
+  const auto worker = [&] {
+    Game own = game;
+    for (std::size_t index = next_task++; index < tasks.size();
+         index = next_task++) {
+      PerftTask &task = tasks[index];
+      own.makeMove(task.move);
+      if (task.reply) {
+        own.makeMove(*task.reply);
+        task.nodes = countNodes(own, depth - 2, options.cache);
+        own.unmakeMove();
+      } else {
+        task.nodes = countNodes(own, depth - 1, options.cache);
+      }
+      own.unmakeMove();
+    }
+  };
+
+  const int threads = threadCount(options.threads);
+  {
+    std::vector<std::jthread> pool;
+    for (int thread = 1; thread < threads; thread++) {
+      pool.emplace_back(worker);
+    }
+    worker();
+  }
+
+  std::vector<PerftDivide> divide(static_cast<std::size_t>(moves.size()));
+  for (int root = 0; root < moves.size(); root++) {
+    divide[static_cast<std::size_t>(root)].move = moves[root];
+  }
+  for (const PerftTask &task : tasks) {
+    divide[static_cast<std::size_t>(task.root)].nodes += task.nodes;
+  }
+  return divide;
+}
+
+} // namespace chess
+
+#if defined(UNIT_TEST)
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+TEST_CASE("perft initial board") {
+  const chess::Game game;
+  CHECK(chess::perft(game, 0) == 1);
+  CHECK(chess::perft(game, 1) == 20);
+  CHECK(chess::perft(game, 2) == 400);
+  CHECK(chess::perft(game, 3) == 8902);
+  CHECK(chess::perft(game, 4) == 197281);
+}
+
+TEST_CASE("perft standard positions") {
+  // Reference counts from the usual perft suites; each position stresses
+  // castling, en passant, promotions or pins
+  SECTION("Kiwipete") {
+    const chess::Game game = chess::Game::fromFen(
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    CHECK(chess::perft(game, 1) == 48);
+    CHECK(chess::perft(game, 2) == 2039);
+    CHECK(chess::perft(game, 3) == 97862);
+  }
+  SECTION("Rook endgame with en passant pins") {
+    const chess::Game game =
+        chess::Game::fromFen("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+    CHECK(chess::perft(game, 1) == 14);
+    CHECK(chess::perft(game, 2) == 191);
+    CHECK(chess::perft(game, 3) == 2812);
+    CHECK(chess::perft(game, 4) == 43238);
+  }
+  SECTION("Promotions and black castling rights with white in check") {
+    const chess::Game game = chess::Game::fromFen(
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+    CHECK(chess::perft(game, 1) == 6);
+    CHECK(chess::perft(game, 2) == 264);
+    CHECK(chess::perft(game, 3) == 9467);
+  }
+  SECTION("Promotion with capture") {
+    const chess::Game game = chess::Game::fromFen(
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8");
+    CHECK(chess::perft(game, 1) == 44);
+    CHECK(chess::perft(game, 2) == 1486);
+    CHECK(chess::perft(game, 3) == 62379);
+  }
+}
+
+TEST_CASE("perftDivide adds up to perft") {
+  const chess::Game game;
+  const auto divide = chess::perftDivide(game, 3);
+  REQUIRE(divide.size() == 20);
+  const std::uint64_t total = std::accumulate(
+      divide.begin(), divide.end(), std::uint64_t{0},
+      [](const std::uint64_t sum, const chess::PerftDivide &entry) {
+        return sum + entry.nodes;
+      });
+  CHECK(total == 8902);
+  const auto e2e4 = std::find_if(
+      divide.begin(), divide.end(), [](const chess::PerftDivide &entry) {
+        return chess::toString(entry.move) == "E2-E4";
+      });
+  REQUIRE(e2e4 != divide.end());
+  CHECK(e2e4->nodes == 600);
+}
+
+TEST_CASE("perft with threads and a cache") {
+  const chess::Game game;
+  const auto single = chess::perftDivide(game, 4);
+
+  SECTION("Root moves") {
+    const auto divide =
+        chess::perftDivide(game, 4, chess::PerftOptions{.threads = 4});
+    REQUIRE(divide.size() == single.size());
+    for (std::size_t i = 0; i < divide.size(); i++) {
+      CHECK(divide[i].move == single[i].move);
+      CHECK(divide[i].nodes == single[i].nodes);
+    }
+  }
+  SECTION("Replies and cache") {
+    chess::PerftCache cache{1};
+    const chess::PerftOptions options{
+        .threads = 3, .splitReplies = true, .cache = &cache};
+    const auto divide = chess::perftDivide(game, 4, options);
+    REQUIRE(divide.size() == single.size());
+    for (std::size_t i = 0; i < divide.size(); i++) {
+      CHECK(divide[i].nodes == single[i].nodes);
+    }
+    // Served from the cache the second time
+    CHECK(chess::perft(game, 4, &cache) == 197281);
+    CHECK(cache.find(game.hash(), 4) == 197281);
+  }
+}
+
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "move.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace chess {
+class Game;
+
+/// The number of leaf nodes below one root move
+struct PerftDivide {
+  Move move;
+  std::uint64_t nodes = 0;
+};
+
+/// @brief perft() results shared between threads, keyed by Game::hash()
+///  and depth, so that a subtree reached by transposition is counted once.
+///
+/// Entries are written without locks. Each one stores its key xor-ed with
+/// its data, so an entry torn by two concurrent writers fails the key check
+/// instead of returning a wrong count.
+class PerftCache {
+public:
+  /// @param size_in_mb The memory to use, rounded down to a power of two
+  ///  number of entries.
+  explicit PerftCache(std::size_t size_in_mb);
+
+  [[nodiscard]] std::optional<std::uint64_t> find(std::uint64_t key,
+                                                  int depth) const;
+  /// Overwrites whatever the slot of @a key held.
+  void store(std::uint64_t key, int depth, std::uint64_t nodes);
+
+private:
+  struct Entry {
+    std::atomic<std::uint64_t> check{0};
+    std::atomic<std::uint64_t> data{0};
+  };
+
+  std::unique_ptr<Entry[]> mEntries;
+  std::size_t mMask = 0;
+};
+
+struct PerftOptions {
+  /// Worker threads, 0 for one per hardware thread
+  int threads = 1;
+  /// Hands out every reply to a root move as its own piece of work, which
+  /// balances the load better when a few root moves dominate
+  bool splitReplies = false;
+  PerftCache *cache = nullptr;
+};
+
+/// @brief Counts the positions reached from @a game after exactly @a depth
+///  legal moves.
+///
+/// The moves are made and unmade on one copy of the game, so @a game is left
+/// untouched.
+[[nodiscard]] std::uint64_t perft(const Game &game, int depth,
+                                  PerftCache *cache = nullptr);
+
+/// @return perft() of every root move of @a game at @a depth, in move
+///  generation order. The subtrees are counted on options.threads threads,
+///  each playing its moves on its own copy of @a game.
+[[nodiscard]] std::vector<PerftDivide>
+perftDivide(const Game &game, int depth, const PerftOptions &options = {});
+} // namespace chess
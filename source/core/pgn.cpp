@@ -0,0 +1,513 @@
+#include "pgn.hpp"
+#include "game.hpp"
+#include "mapped_file.hpp"
+#include "movegen.hpp"
+#include "thread_count.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace chess {
+namespace {
+constexpr std::string_view kWhitespace = " \t\r\n";
+
+/// @return The piece of a SAN piece letter, which is always upper case.
+std::optional<Piece> sanPiece(const char letter) {
+  switch (letter) {
+  case 'N':
+    return Piece::kKnight;
+  case 'B':
+    return Piece::kBishop;
+  case 'R':
+    return Piece::kRook;
+  case 'Q':
+    return Piece::kQueen;
+  case 'K':
+    return Piece::kKing;
+  default:
+    return std::nullopt;
+  }
+}
+
+bool isResult(const std::string_view token) {
+  return token == "1-0" || token == "0-1" || token == "1/2-1/2" ||
+         token == "*";
+}
+
+/// @return The position just past the end of the tag starting at @a pos,
+///  with its name and value read into @a name and @a value.
+std::size_t readTag(const std::string_view text, std::size_t pos,
+                    std::string_view &name, std::string &value) {
+  // Skip the opening bracket
+  pos++;
+  const std::size_t name_start = text.find_first_not_of(kWhitespace, pos);
+  const std::size_t name_end = text.find_first_of(" \t\"]", name_start);
+  if (name_start == std::string_view::npos ||
+      name_end == std::string_view::npos) {
+    return text.size();
+  }
+  name = text.substr(name_start, name_end - name_start);
+
+  value.clear();
+  pos = text.find_first_of("\"]", name_end);
+  if (pos != std::string_view::npos && text[pos] == '"') {
+    for (pos++; pos < text.size() && text[pos] != '"'; pos++) {
+      if (text[pos] == '\\' && pos + 1 < text.size()) {
+        pos++;
+      }
+      value += text[pos];
+    }
+    pos = text.find(']', pos);
+  }
+  return pos == std::string_view::npos ? text.size() : pos + 1;
+}
+
+/// @return The position just past the variation starting at @a pos,
+///  including the variations nested in it.
+std::size_t skipVariation(const std::string_view text, std::size_t pos) {
+  int depth = 0;
+  for (; pos < text.size(); pos++) {
+    if (text[pos] == '{') {
+      pos = text.find('}', pos);
+      if (pos == std::string_view::npos) {
+        return text.size();
+      }
+    } else if (text[pos] == '(') {
+      depth++;
+    } else if (text[pos] == ')' && --depth == 0) {
+      return pos + 1;
+    }
+  }
+  return text.size();
+}
+} // namespace
+
+std::optional<Move> parseSan(const GameState &state, std::string_view san) {
+  // Check, mate and annotation marks say nothing about the move itself
+  while (!san.empty() &&
+         std::string_view{"+#!?"}.find(san.back()) != std::string_view::npos) {
+    san.remove_suffix(1);
+  }
+
+  MoveList moves;
+  generateLegalMoves(state, moves);
+
+  if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+    const int column = san.size() == 3 ? 6 : 2;
+    for (const Move &move : moves) {
+      if (move.flag() == MoveFlag::kCastling && move.to().iColumn == column) {
+        return move;
+      }
+    }
+    return std::nullopt;
+  }
+
+  Piece piece = Piece::kPawn;
+  if (!san.empty()) {
+    if (const std::optional<Piece> letter = sanPiece(san.front())) {
+      piece = *letter;
+      san.remove_prefix(1);
+    }
+  }
+
+  // "e8=Q", or "e8Q" as some programs write it
+  std::optional<Piece> promotion;
+  if (const std::size_t equals = san.find('=');
+      equals != std::string_view::npos) {
+    if (equals + 2 != san.size()) {
+      return std::nullopt;
+    }
+    promotion = sanPiece(san.back());
+    if (!promotion) {
+      return std::nullopt;
+    }
+    san = san.substr(0, equals);
+  } else if (piece == Piece::kPawn && !san.empty() &&
+             std::string_view{"NBRQ"}.find(san.back()) !=
+                 std::string_view::npos) {
+    promotion = sanPiece(san.back());
+    san.remove_suffix(1);
+  }
+
+  if (san.size() < 2) {
+    return std::nullopt;
+  }
+  const char file = san[san.size() - 2];
+  const char rank = san[san.size() - 1];
+  if (file < 'a' || file > 'h' || rank < '1' || rank > '8') {
+    return std::nullopt;
+  }
+  const int to = (rank - '1') * kNumCols + (file - 'a');
+  san.remove_suffix(2);
+
+  // What is left tells the origin apart: its file, its row or both, and an
+  // x for captures
+  std::optional<int> from_column;
+  std::optional<int> from_row;
+  for (const char c : san) {
+    if (c >= 'a' && c <= 'h') {
+      from_column = c - 'a';
+    } else if (c >= '1' && c <= '8') {
+      from_row = c - '1';
+    } else if (c != 'x' && c != ':' && c != '-') {
+      return std::nullopt;
+    }
+  }
+
+  const Board &board = state.board();
+  std::optional<Move> found;
+  for (const Move &move : moves) {
+    const Position from = move.from();
+    if (move.toSquare() != to || board(from)->mPiece != piece ||
+        (from_column && from.iColumn != *from_column) ||
+        (from_row && from.iRow != *from_row)) {
+      continue;
+    }
+    if (move.flag() == MoveFlag::kPromotion
+            ? move.promotion() != promotion
+            : promotion.has_value()) {
+      continue;
+    }
+    if (found) {
+      // Ambiguous
+      return std::nullopt;
+    }
+    found = move;
+  }
+  return found;
+}
+
+Game PgnGame::replay() const {
+  Game game = fen.empty() ? Game{} : Game::fromFen(fen);
+  for (const Move &move : moves) {
+    game.playMove(move);
+  }
+  return game;
+}
+
+std::vector<std::string_view> splitPgnGames(const std::string_view text,
+                                            const std::size_t limit) {
+  std::vector<std::string_view> games;
+  std::size_t start = std::string_view::npos;
+  bool in_movetext = false;
+  bool in_comment = false;
+
+  for (std::size_t pos = 0; pos < text.size();) {
+    const std::size_t line_end = std::min(text.find('\n', pos), text.size());
+    const std::string_view line = text.substr(pos, line_end - pos);
+
+    if (!in_comment && !line.empty() && line.front() == '[') {
+      // A tag after moves starts the next game
+      if (start == std::string_view::npos || in_movetext) {
+        if (start != std::string_view::npos) {
+          games.push_back(text.substr(start, pos - start));
+          if (games.size() == limit) {
+            return games;
+          }
+        }
+        start = pos;
+        in_movetext = false;
+      }
+    } else if (line.find_first_not_of(kWhitespace) != std::string_view::npos) {
+      if (start == std::string_view::npos) {
+        start = pos;
+      }
+      in_movetext = true;
+      // A brace comment may span lines and hold a '[' at the start of one
+      for (const char c : line) {
+        if (in_comment) {
+          in_comment = c != '}';
+        } else if (c == '{') {
+          in_comment = true;
+        } else if (c == ';') {
+          break;
+        }
+      }
+    }
+    pos = line_end + 1;
+  }
+  if (start != std::string_view::npos) {
+    games.push_back(text.substr(start));
+  }
+  return games;
+}
+
+PgnGame parsePgnGame(const std::string_view text) {
+  PgnGame game;
+  GameState state;
+  std::string value;
+
+  for (std::size_t pos = 0; pos < text.size();) {
+    const char c = text[pos];
+    if (kWhitespace.find(c) != std::string_view::npos) {
+      pos++;
+    } else if (c == '[') {
+      std::string_view name;
+      pos = readTag(text, pos, name, value);
+      if (name == "FEN") {
+        try {
+          state = GameState::fromFen(value);
+        } catch (const GameException &err) {
+          game.error = err.what();
+          return game;
+        }
+        game.fen = state.toFen();
+      } else if (name == "Result") {
+        game.result = value;
+      }
+    } else if (c == '{') {
+      pos = std::min(text.find('}', pos), text.size() - 1) + 1;
+    } else if (c == ';') {
+      pos = std::min(text.find('\n', pos), text.size() - 1) + 1;
+    } else if (c == '(') {
+      pos = skipVariation(text, pos);
+    } else if (c == '$') {
+      // Numeric annotation glyph
+      pos = std::min(text.find_first_of(kWhitespace, pos), text.size());
+    } else {
+      // A stray closing bracket is a token of its own
+      const std::size_t end = std::min(
+          text.find_first_of(" \t\r\n{}();[", pos + 1), text.size());
+      std::string_view token = text.substr(pos, end - pos);
+      pos = end;
+      if (isResult(token)) {
+        break;
+      }
+
+      // A move number, possibly glued to the move: "12.", "12...e5"
+      const std::size_t number_end = token.find_first_not_of("0123456789");
+      if (number_end != std::string_view::npos && number_end > 0 &&
+          token[number_end] == '.') {
+        token.remove_prefix(
+            std::min(token.find_first_not_of('.', number_end), token.size()));
+      }
+      if (token.empty() || token == ")" || token == "}") {
+        continue;
+      }
+
+      const std::optional<Move> move = parseSan(state, token);
+      if (!move) {
+        game.error = "Illegal move " + std::string{token} + " at ply " +
+                     std::to_string(game.moves.size() + 1);
+        return game;
+      }
+      game.moves.push_back(*move);
+      state.makeMove(*move);
+    }
+  }
+  return game;
+}
+
+double PgnStats::gamesPerSecond() const {
+  return seconds > 0.0 ? static_cast<double>(games) / seconds : 0.0;
+}
+
+double PgnDatabase::gamesPerSecond() const {
+  return seconds > 0.0 ? static_cast<double>(games.size()) / seconds : 0.0;
+}
+
+PgnStats readPgn(const std::filesystem::path &file, const PgnSink &sink,
+                 const PgnOptions &options) {
+  const auto start = std::chrono::steady_clock::now();
+  const MappedFile mapped{file};
+  std::string_view rest = mapped.text();
+  const std::size_t chunk = std::max<std::size_t>(options.chunk, 1);
+
+  PgnStats stats;
+  std::vector<PgnGame> parsed;
+  while (!rest.empty() || !parsed.empty()) {
+    const std::vector<std::string_view> texts = splitPgnGames(rest, chunk);
+    if (texts.empty()) {
+      rest = {};
+    } else {
+      const std::string_view last = texts.back();
+      rest.remove_prefix(
+          static_cast<std::size_t>(last.data() + last.size() - rest.data()));
+    }
+
+    std::vector<PgnGame> games(texts.size());
+    std::atomic<std::size_t> next_game{0};
+    const auto worker = [&] {
+      for (std::size_t index = next_game++; index < texts.size();
+           index = next_game++) {
+        games[index] = parsePgnGame(texts[index]);
+      }
+    };
+    {
+      std::vector<std::jthread> pool;
+      if (!texts.empty()) {
+        for (int thread = 0; thread < threadCount(options.threads);
+             thread++) {
+          pool.emplace_back(worker);
+        }
+      }
+      // The previous chunk is handed on while this one is parsed
+      for (PgnGame &game : parsed) {
+        stats.games++;
+        stats.failed += game.error.empty() ? 0 : 1;
+        sink(std::move(game));
+      }
+    }
+    parsed = std::move(games);
+  }
+
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  stats.seconds = elapsed.count();
+  return stats;
+}
+
+PgnDatabase readPgn(const std::filesystem::path &file,
+                    const PgnOptions &options) {
+  PgnDatabase database;
+  const PgnStats stats = readPgn(
+      file,
+      [&database](PgnGame &&game) {
+        database.games.push_back(std::move(game));
+      },
+      options);
+  database.failed = stats.failed;
+  database.seconds = stats.seconds;
+  return database;
+}
+} // namespace chess
+
+#if defined(UNIT_TEST)
+
+#include "temp_file.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <fstream>
+
+namespace {
+std::string san(const std::string_view fen, const std::string_view text) {
+  const std::optional<chess::Move> move =
+      chess::parseSan(chess::GameState::fromFen(fen), text);
+  return move ? chess::toString(*move) : "none";
+}
+} // namespace
+
+TEST_CASE("parseSan") {
+  using namespace std::string_view_literals;
+  const std::string_view start = chess::kStartFen;
+  CHECK(san(start, "e4") == "E2-E4");
+  CHECK(san(start, "Nf3") == "G1-F3");
+  CHECK(san(start, "e5") == "none");
+  CHECK(san(start, "Ke2") == "none");
+
+  SECTION("Disambiguation") {
+    // Knights on B1 and F3 can both reach D2, rooks on A1 and A5 can reach A3
+    const auto fen = "4k3/8/8/R7/8/8/8/RN2K3 w - - 0 1"sv;
+    CHECK(san(fen, "Ra3") == "none");
+    CHECK(san(fen, "R1a3") == "A1-A3");
+    CHECK(san(fen, "R5a3+") == "A5-A3");
+    const auto knights = "4k3/8/8/8/8/5N2/8/1N2K3 w - - 0 1"sv;
+    CHECK(san(knights, "Nd2") == "none");
+    CHECK(san(knights, "Nbd2") == "B1-D2");
+    CHECK(san(knights, "Nfd2") == "F3-D2");
+  }
+  SECTION("Castling") {
+    const auto fen = "r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1"sv;
+    CHECK(san(fen, "O-O") == "E8-G8");
+    CHECK(san(fen, "O-O-O") == "E8-C8");
+    CHECK(san(fen, "0-0-0") == "E8-C8");
+  }
+  SECTION("Promotion") {
+    const auto fen = "1n2k3/P7/8/8/8/8/8/4K3 w - - 0 1"sv;
+    CHECK(san(fen, "a8=Q") == "A7-A8=Q");
+    CHECK(san(fen, "axb8=N+") == "A7-B8=N");
+    CHECK(san(fen, "axb8R") == "A7-B8=R");
+    CHECK(san(fen, "a8") == "none");
+  }
+  SECTION("En passant") {
+    const auto fen = "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 2"sv;
+    CHECK(san(fen, "exd6") == "E5-D6");
+    CHECK(chess::parseSan(chess::GameState::fromFen(fen), "exd6")->flag() ==
+          chess::MoveFlag::kEnPassant);
+  }
+}
+
+TEST_CASE("PGN games") {
+  const std::string text =
+      "[Event \"First\"]\n"
+      "[Result \"1-0\"]\n"
+      "\n"
+      "1. e4 e5 {a comment\n"
+      "[that looks like a tag]} 2. Bc4 (2. Nf3 Nc6 (2... d6)) Nc6\n"
+      "3. Qh5 $2 Nf6?? 4. Qxf7# 1-0\n"
+      "\n"
+      "[Event \"Second\"]\n"
+      "[FEN \"4k3/8/8/8/8/8/8/R3K3 b Q - 3 40\"]\n"
+      "\n"
+      "40... Kd7 41. O-O-O+ ; castles with check\n"
+      "Ke6 *\n"
+      "\n"
+      "[Event \"Third\"]\n"
+      "\n"
+      "1. e4 e5 2. Ke3 1/2-1/2\n";
+
+  const std::vector<std::string_view> games = chess::splitPgnGames(text);
+  REQUIRE(games.size() == 3);
+  CHECK(games[1].starts_with("[Event \"Second\"]"));
+  const std::vector<std::string_view> limited =
+      chess::splitPgnGames(text, 2);
+  CHECK(limited == std::vector<std::string_view>{games[0], games[1]});
+
+  const chess::PgnGame first = chess::parsePgnGame(games[0]);
+  CHECK(first.error.empty());
+  CHECK(first.fen.empty());
+  CHECK(first.result == "1-0");
+  REQUIRE(first.moves.size() == 7);
+  CHECK(chess::toString(first.moves[6]) == "H5-F7");
+  CHECK(first.replay().status() == chess::GameStatus::kCheckmate);
+
+  const chess::PgnGame second = chess::parsePgnGame(games[1]);
+  CHECK(second.error.empty());
+  CHECK(second.fen == "4k3/8/8/8/8/8/8/R3K3 b Q - 3 40");
+  CHECK(second.result == "*");
+  REQUIRE(second.moves.size() == 3);
+  CHECK(second.moves[1].flag() == chess::MoveFlag::kCastling);
+  CHECK(second.replay().toFen() == "8/8/4k3/8/8/8/8/2KR4 w - - 6 42");
+
+  const chess::PgnGame third = chess::parsePgnGame(games[2]);
+  CHECK(third.error == "Illegal move Ke3 at ply 3");
+  CHECK(third.moves.size() == 2);
+
+  SECTION("readPgn") {
+    const std::filesystem::path file =
+        chess::uniqueTempPath(std::filesystem::temp_directory_path(),
+                              "chess_pgn_test.pgn");
+    {
+      std::ofstream out{file, std::ios::binary};
+      for (int copy = 0; copy < 20; copy++) {
+        out << text << '\n';
+      }
+    }
+    const chess::PgnDatabase database = chess::readPgn(file, {.threads = 4});
+    REQUIRE(database.games.size() == 60);
+    CHECK(database.failed == 20);
+    for (std::size_t index = 0; index < database.games.size(); index++) {
+      CHECK(database.games[index].moves ==
+            chess::parsePgnGame(games[index % 3]).moves);
+    }
+
+    // Chunks that split the copies of the text still keep the file order
+    std::size_t received = 0;
+    const chess::PgnStats stats = chess::readPgn(
+        file,
+        [&](chess::PgnGame &&game) {
+          CHECK(game.moves == database.games[received++].moves);
+        },
+        {.threads = 3, .chunk = 7});
+    CHECK(received == 60);
+    CHECK(stats.games == 60);
+    CHECK(stats.failed == 20);
+    std::filesystem::remove(file);
+  }
+}
+
+#endif
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "move.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace chess {
+class Game;
+class GameState;
+
+/// @return The legal move of the side to move in @a state written as
+///  @a san in Standard Algebraic Notation, e.g. "Nbd7", "exd6", "O-O" or
+///  "e8=Q+", or std::nullopt if no single legal move matches.
+[[nodiscard]] std::optional<Move> parseSan(const GameState &state,
+                                           std::string_view san);
+
+/// One game read from PGN, as a compact move sequence
+struct PgnGame {
+  /// The position of the FEN tag, empty when the game starts from the
+  /// initial position
+  std::string fen;
+  /// The Result tag, e.g. "1-0", or "*" when it is missing
+  std::string result = "*";
+  std::vector<Move> moves;
+  /// Why the game could not be read, empty if it was. The moves before the
+  /// failure are kept.
+  std::string error;
+
+  /// @return A Game with the moves played and logged.
+  [[nodiscard]] Game replay() const;
+};
+
+/// @return Every game of a PGN database in @a text, each one starting at its
+///  first tag. Only tag lines and comments are looked at, so this is a quick
+///  pass to share the games out before they are parsed. At most @a limit
+///  games are returned; the rest of the database then starts right after the
+///  last one.
+[[nodiscard]] std::vector<std::string_view>
+splitPgnGames(std::string_view text,
+              std::size_t limit = std::numeric_limits<std::size_t>::max());
+
+/// Reads one game found by splitPgnGames()
+[[nodiscard]] PgnGame parsePgnGame(std::string_view text);
+
+struct PgnOptions {
+  /// Worker threads, 0 for one per hardware thread
+  int threads = 0;
+  /// Games parsed together before they are handed on. At most two chunks of
+  /// games are held at once, whatever the size of the file.
+  std::size_t chunk = 4096;
+};
+
+struct PgnStats {
+  std::size_t games = 0;
+  /// How many of the games could not be read to the end
+  std::size_t failed = 0;
+  double seconds = 0.0;
+
+  [[nodiscard]] double gamesPerSecond() const;
+};
+
+/// Receives each game read, in the order of the file
+using PgnSink = std::function<void(PgnGame &&game)>;
+
+/// @brief Reads the PGN file @a file chunk by chunk, see PgnOptions::chunk,
+///  and hands every game to @a sink in the order of the file.
+///
+/// The file is mapped into memory and each chunk is parsed on
+/// options.threads threads while @a sink is given the games of the chunk
+/// before, so the games are never all held at once.
+/// @throws GameException if @a file can not be read. Exceptions thrown by
+///  @a sink are passed on.
+PgnStats readPgn(const std::filesystem::path &file, const PgnSink &sink,
+                 const PgnOptions &options = {});
+
+struct PgnDatabase {
+  std::vector<PgnGame> games;
+  /// How many of games could not be read to the end
+  std::size_t failed = 0;
+  double seconds = 0.0;
+
+  [[nodiscard]] double gamesPerSecond() const;
+};
+
+/// @brief Reads every game of the PGN file @a file into memory, see the
+///  streaming readPgn(). Games keep the order of the file.
+/// @throws GameException if @a file can not be read.
+[[nodiscard]] PgnDatabase readPgn(const std::filesystem::path &file,
+                                  const PgnOptions &options = {});
+} // namespace chess
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <optional>
 #include <ostream>
 
@@ -21,6 +22,35 @@ using SquareState = std::optional<PieceWithSide>;
 
 std::ostream &operator<<(std::ostream &stream, const SquareState &piece);
 
+/// @brief One-byte encoding of a SquareState.
+///
+/// The low three bits hold the piece type plus one and bit 3 holds the side,
+/// so zero is an empty square and a full board of codes is 64 bytes.
+enum struct PieceCode : std::uint8_t { kEmpty = 0 };
+
+constexpr std::uint8_t kPieceCodeSideBit = 0x08;
+constexpr std::uint8_t kPieceCodePieceMask = 0x07;
+
+[[nodiscard]] constexpr PieceCode encodePiece(const SquareState state) {
+  if (!state) {
+    return PieceCode::kEmpty;
+  }
+  const auto piece = static_cast<std::uint8_t>(state->mPiece) + 1;
+  const std::uint8_t side =
+      state->mSide == Side::kBlack ? kPieceCodeSideBit : 0;
+  return static_cast<PieceCode>(piece | side);
+}
+
+[[nodiscard]] constexpr SquareState decodePiece(const PieceCode code) {
+  const auto bits = static_cast<std::uint8_t>(code);
+  if (bits == 0) {
+    return std::nullopt;
+  }
+  return PieceWithSide{
+      .mPiece = static_cast<Piece>((bits & kPieceCodePieceMask) - 1),
+      .mSide = (bits & kPieceCodeSideBit) ? Side::kBlack : Side::kWhite};
+}
+
 namespace pieces {
 constexpr auto R = PieceWithSide{.mPiece = Piece::kRook, .mSide = Side::kWhite};
 constexpr auto N =
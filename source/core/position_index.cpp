@@ -0,0 +1,301 @@
+#include "position_index.hpp"
+#include "byte_order.hpp"
+#include "game.hpp"
+#include "game_archive.hpp"
+#include "sorted_runs.hpp"
+#include "validation.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <fstream>
+
+namespace chess {
+namespace {
+constexpr std::array<char, 4> kMagic{'C', 'C', 'P', 'I'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 24;
+constexpr std::size_t kPostingSize = 16;
+/// Postings written to the file at a time
+constexpr std::size_t kPostingsPerWrite = 4096;
+
+/// A posting in a run file or in the index: the key, the game and the ply
+struct PostingFormat {
+  using Record = PositionPosting;
+  static constexpr std::size_t kSize = kPostingSize;
+
+  static void append(std::vector<std::byte> &bytes,
+                     const PositionPosting &posting) {
+    appendLittleEndian(bytes, posting.key);
+    appendLittleEndian(bytes, posting.game);
+    appendLittleEndian(bytes, posting.ply);
+  }
+
+  static PositionPosting read(const std::span<const std::byte> bytes,
+                              const std::size_t offset) {
+    return {.key = readLittleEndian<std::uint64_t>(bytes, offset),
+            .game = readLittleEndian<std::uint32_t>(bytes, offset + 8),
+            .ply = readLittleEndian<std::uint32_t>(bytes, offset + 12)};
+  }
+};
+
+/// @brief Adds the position before each move of game @a game to
+///  @a postings, up to @a max_ply.
+/// @return False if the game stops at an illegal move.
+bool indexGame(const GameArchive &archive, const std::size_t game,
+               const std::uint32_t max_ply,
+               std::vector<PositionPosting> &postings) {
+  const auto id = static_cast<std::uint32_t>(game);
+  try {
+    const ArchivedGame archived = archive[game];
+    GameState state = archived.fen().empty()
+                          ? GameState{}
+                          : GameState::fromFen(archived.fen());
+    postings.push_back({.key = state.hash(), .game = id, .ply = 0});
+
+    const std::size_t plies =
+        max_ply == 0 ? archived.moveCount()
+                     : std::min<std::size_t>(max_ply, archived.moveCount());
+    for (std::size_t ply = 0; ply < plies; ply++) {
+      const Move move = archived.move(ply);
+      const MoveValidation result = validateMove(state, move);
+      if (!result.valid() || result.move != move) {
+        return false;
+      }
+      state.makeMove(move);
+      postings.push_back({.key = state.hash(),
+                          .game = id,
+                          .ply = static_cast<std::uint32_t>(ply + 1)});
+    }
+  } catch (const GameException &) {
+    return false;
+  }
+  return true;
+}
+} // namespace
+
+PositionIndexStats buildPositionIndex(const GameArchive &archive,
+                                      const std::filesystem::path &file,
+                                      const PositionIndexOptions &options) {
+  const auto start = std::chrono::steady_clock::now();
+  std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+  if (!stream) {
+    throw GameException("Can't create " + file.string());
+  }
+
+  SortedRuns<PostingFormat> runs{file.filename().string(), options.sort};
+  const std::size_t failed = runs.fill(
+      archive.size(),
+      [&](const std::size_t game, std::vector<PositionPosting> &postings) {
+        return indexGame(archive, game, options.maxPly, postings);
+      });
+
+  std::vector<std::byte> bytes;
+  for (const char c : kMagic) {
+    bytes.push_back(static_cast<std::byte>(c));
+  }
+  appendLittleEndian(bytes, kVersion);
+  appendLittleEndian(bytes, static_cast<std::uint64_t>(runs.records()));
+  appendLittleEndian(bytes, static_cast<std::uint64_t>(archive.size()));
+  runs.merge([&](const PositionPosting &posting) {
+    PostingFormat::append(bytes, posting);
+    if (bytes.size() >= kPostingsPerWrite * kPostingSize) {
+      writeBytes(stream, bytes);
+      bytes.clear();
+    }
+  });
+  writeBytes(stream, bytes);
+  stream.close();
+  if (!stream) {
+    throw GameException("Can't write " + file.string());
+  }
+
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return {.games = archive.size(),
+          .postings = runs.records(),
+          .failed = failed,
+          .runs = runs.size(),
+          .seconds = elapsed.count()};
+}
+
+PositionIndex::PositionIndex(const std::filesystem::path &file)
+    : mFile(file) {
+  const std::span<const std::byte> bytes = mFile.bytes();
+  if (bytes.size() < kHeaderSize) {
+    throw GameException(file.string() + " is not a position index");
+  }
+  for (std::size_t i = 0; i < kMagic.size(); i++) {
+    if (bytes[i] != static_cast<std::byte>(kMagic[i])) {
+      throw GameException(file.string() + " is not a position index");
+    }
+  }
+  if (readLittleEndian<std::uint32_t>(bytes, 4) != kVersion) {
+    throw GameException(file.string() + " has an unknown index version");
+  }
+  const std::uint64_t size = readLittleEndian<std::uint64_t>(bytes, 8);
+  if (size != (bytes.size() - kHeaderSize) / kPostingSize ||
+      (bytes.size() - kHeaderSize) % kPostingSize != 0) {
+    throw GameException(file.string() + " is damaged");
+  }
+  mSize = static_cast<std::size_t>(size);
+  mGameCount =
+      static_cast<std::size_t>(readLittleEndian<std::uint64_t>(bytes, 16));
+}
+
+std::size_t PositionIndex::size() const { return mSize; }
+
+std::size_t PositionIndex::gameCount() const { return mGameCount; }
+
+PositionPosting PositionIndex::operator[](const std::size_t index) const {
+  assert(index < mSize);
+  const std::span<const std::byte> bytes = mFile.bytes();
+  return PostingFormat::read(bytes, kHeaderSize + index * kPostingSize);
+}
+
+std::size_t PositionIndex::count(const std::uint64_t key) const {
+  // The postings of key end where those of the next key would start
+  const std::size_t end = key == std::numeric_limits<std::uint64_t>::max()
+                              ? mSize
+                              : lowerBound(key + 1);
+  return end - lowerBound(key);
+}
+
+std::vector<PositionPosting>
+PositionIndex::find(const std::uint64_t key, const std::size_t limit) const {
+  std::vector<PositionPosting> postings;
+  for (std::size_t index = lowerBound(key);
+       index < mSize && postings.size() < limit && keyAt(index) == key;
+       index++) {
+    postings.push_back((*this)[index]);
+  }
+  return postings;
+}
+
+std::vector<PositionPosting>
+PositionIndex::find(const GameState &state, const std::size_t limit) const {
+  return find(state.hash(), limit);
+}
+
+std::size_t PositionIndex::lowerBound(const std::uint64_t key) const {
+  std::size_t first = 0;
+  std::size_t length = mSize;
+  while (length > 0) {
+    const std::size_t half = length / 2;
+    if (keyAt(first + half) < key) {
+      first += half + 1;
+      length -= half + 1;
+    } else {
+      length = half;
+    }
+  }
+  return first;
+}
+
+std::uint64_t PositionIndex::keyAt(const std::size_t index) const {
+  return readLittleEndian<std::uint64_t>(mFile.bytes(),
+                                         kHeaderSize + index * kPostingSize);
+}
+} // namespace chess
+
+#if defined(UNIT_TEST)
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("PositionIndex") {
+  const std::filesystem::path archive_file = chess::uniqueTempPath(
+      std::filesystem::temp_directory_path(), "chess_index_test.cga");
+  const std::filesystem::path index_file = chess::uniqueTempPath(
+      std::filesystem::temp_directory_path(), "chess_index_test.cpi");
+
+  // 1. e4 c5 2. Nf3, the same from the position after 1. e4, and 1. Nf3 c5
+  // 2. e4, which transposes
+  const chess::Move e4{{1, 4}, {3, 4}};
+  const chess::Move c5{{6, 2}, {4, 2}};
+  const chess::Move nf3{{0, 6}, {2, 5}};
+  const chess::GameState start;
+  chess::GameState after_e4 = start;
+  after_e4.makeMove(e4);
+  const std::array<chess::Move, 3> sicilian{e4, c5, nf3};
+  const std::array<chess::Move, 3> reti{nf3, c5, e4};
+  // Illegal from the second move on
+  const std::array<chess::Move, 3> broken{e4, e4, c5};
+  {
+    chess::ArchiveWriter writer{archive_file};
+    writer.add("", sicilian);
+    writer.add(after_e4.toFen(), std::span{sicilian}.subspan(1));
+    writer.add("", reti);
+    writer.add("", broken);
+    writer.finish();
+  }
+  const chess::GameArchive archive{archive_file};
+
+  SECTION("Every ply") {
+    const chess::PositionIndexStats stats =
+        chess::buildPositionIndex(archive, index_file,
+                                  {.sort = {.threads = 3}});
+    CHECK(stats.games == 4);
+    CHECK(stats.failed == 1);
+    CHECK(stats.postings == 4 + 3 + 4 + 2);
+
+    const chess::PositionIndex index{index_file};
+    CHECK(index.size() == stats.postings);
+    CHECK(index.gameCount() == 4);
+    for (std::size_t i = 1; i < index.size(); i++) {
+      CHECK(index[i - 1] < index[i]);
+    }
+
+    CHECK(index.count(start.hash()) == 3);
+    const std::vector<chess::PositionPosting> found = index.find(after_e4);
+    REQUIRE(found.size() == 3);
+    CHECK(found[0].game == 0);
+    CHECK(found[0].ply == 1);
+    CHECK(found[1].game == 1);
+    CHECK(found[1].ply == 0);
+    CHECK(found[2].game == 3);
+    CHECK(index.find(after_e4, 1).size() == 1);
+
+    // The position after 2. Nf3 and after 2. e4
+    chess::GameState end = after_e4;
+    end.makeMove(c5);
+    end.makeMove(nf3);
+    const std::vector<chess::PositionPosting> transposed = index.find(end);
+    REQUIRE(transposed.size() == 3);
+    CHECK(transposed[2].game == 2);
+    CHECK(transposed[2].ply == 3);
+
+    CHECK(index.find(0).empty());
+    CHECK(index.count(~std::uint64_t{0}) == 0);
+  }
+  SECTION("More postings than fit in memory") {
+    const chess::PositionIndexStats stats = chess::buildPositionIndex(
+        archive, index_file,
+        {.sort = {.threads = 2,
+                  .memory = 3 * sizeof(chess::PositionPosting)}});
+    CHECK(stats.runs > 2);
+    CHECK(stats.postings == 4 + 3 + 4 + 2);
+
+    const chess::PositionIndex index{index_file};
+    REQUIRE(index.size() == stats.postings);
+    for (std::size_t i = 1; i < index.size(); i++) {
+      CHECK(index[i - 1] < index[i]);
+    }
+    CHECK(index.count(start.hash()) == 3);
+    CHECK(index.find(after_e4).size() == 3);
+  }
+  SECTION("Opening plies only") {
+    const chess::PositionIndexStats stats = chess::buildPositionIndex(
+        archive, index_file, {.maxPly = 1, .sort = {.threads = 1}});
+    CHECK(stats.failed == 0);
+    CHECK(stats.postings == 2 + 2 + 2 + 2);
+  }
+  SECTION("Not an index") {
+    CHECK_THROWS_AS(chess::PositionIndex{archive_file}, chess::GameException);
+  }
+
+  std::filesystem::remove(archive_file);
+  std::filesystem::remove(index_file);
+}
+
+#endif
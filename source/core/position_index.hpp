@@ -0,0 +1,102 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include "sorted_runs.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace chess {
+class GameArchive;
+class GameState;
+
+inline constexpr std::string_view kPositionIndexExtension = ".cpi";
+
+/// A position reached in an archived game: game @a game had the position
+/// with GameState::hash() @a key after @a ply half-moves.
+struct PositionPosting {
+  std::uint64_t key = 0;
+  std::uint32_t game = 0;
+  std::uint32_t ply = 0;
+
+  auto operator<=>(const PositionPosting &) const = default;
+};
+
+struct PositionIndexOptions {
+  /// Only the positions up to this ply are indexed, 0 for all of them
+  std::uint32_t maxPly = 0;
+  /// The threads that replay the games and the memory they sort in
+  SortedRunsOptions sort;
+};
+
+struct PositionIndexStats {
+  std::size_t games = 0;
+  std::size_t postings = 0;
+  /// Games that stop at an illegal move; their positions before it are kept
+  std::size_t failed = 0;
+  /// Sorted runs written before the merge
+  std::size_t runs = 0;
+  double seconds = 0.0;
+};
+
+/// @brief Replays every game of @a archive on options.sort.threads threads
+///  and writes the position of each ply into the index file @a file, see
+///  PositionIndex for the layout.
+///
+/// The postings are sorted through SortedRuns, so an archive may hold more
+/// positions than fit in memory.
+/// @throws GameException if @a file or a run can not be written.
+PositionIndexStats buildPositionIndex(const GameArchive &archive,
+                                      const std::filesystem::path &file,
+                                      const PositionIndexOptions &options = {});
+
+/// @brief Finds the games that reached a position, in an index file written
+///  by buildPositionIndex() and mapped into memory.
+///
+/// The file starts with a 24 byte header: the magic "CCPI", a 32 bit version,
+/// the 64 bit number of postings and the 64 bit number of games indexed.
+/// Then come the postings sorted by key, game and ply, 16 bytes each: the
+/// 64 bit key, the 32 bit game and the 32 bit ply. All numbers are little
+/// endian. A lookup is a binary search, so no more than about 40 postings
+/// are read whatever the size of the index.
+class PositionIndex {
+public:
+  /// @throws GameException if @a file can not be read or is not an index.
+  explicit PositionIndex(const std::filesystem::path &file);
+
+  /// @return The number of postings.
+  [[nodiscard]] std::size_t size() const;
+
+  /// @return The number of games of the archive that was indexed.
+  [[nodiscard]] std::size_t gameCount() const;
+
+  [[nodiscard]] PositionPosting operator[](std::size_t index) const;
+
+  /// @return How many times a position with @a key was reached.
+  [[nodiscard]] std::size_t count(std::uint64_t key) const;
+
+  /// @return The postings of @a key, at most @a limit of them, by game and
+  ///  ply.
+  [[nodiscard]] std::vector<PositionPosting>
+  find(std::uint64_t key,
+       std::size_t limit = std::numeric_limits<std::size_t>::max()) const;
+
+  /// Same as find(std::uint64_t, std::size_t), for the key of @a state.
+  [[nodiscard]] std::vector<PositionPosting>
+  find(const GameState &state,
+       std::size_t limit = std::numeric_limits<std::size_t>::max()) const;
+
+private:
+  /// @return The first posting whose key is not less than @a key.
+  [[nodiscard]] std::size_t lowerBound(std::uint64_t key) const;
+  [[nodiscard]] std::uint64_t keyAt(std::size_t index) const;
+
+  MappedFile mFile;
+  std::size_t mSize = 0;
+  std::size_t mGameCount = 0;
+};
+} // namespace chess
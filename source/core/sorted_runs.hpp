@@ -0,0 +1,217 @@
+#pragma once
+
+#include "byte_order.hpp"
+#include "game.hpp"
+#include "mapped_file.hpp"
+#include "temp_file.hpp"
+#include "thread_count.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace chess {
+struct SortedRunsOptions {
+  /// Worker threads, 0 for one per hardware thread
+  int threads = 0;
+  /// Bytes of records the workers keep in memory together. When a worker
+  /// has its share, it sorts its records and writes them out as a run.
+  std::size_t memory = std::size_t{256} << 20;
+  /// Where the runs are written, the system temporary directory if empty
+  std::filesystem::path tempDirectory;
+};
+
+/// @brief Records sorted in runs on disk and merged back in order, to sort
+///  more records than fit in memory.
+///
+/// @a Format describes the records: the type Format::Record, ordered with
+/// operator<, its size in bytes Format::kSize, and the static functions
+/// append(std::vector<std::byte> &, const Record &) and
+/// read(std::span<const std::byte>, std::size_t offset) that write and read
+/// one record. Workers may add runs at the same time. The run files are
+/// removed with the object.
+template <typename Format> class SortedRuns {
+public:
+  using Record = typename Format::Record;
+
+  /// @param name The run files are named after @a name, see uniqueTempPath(),
+  ///  followed by ".N.run".
+  SortedRuns(const std::string_view name, SortedRunsOptions options)
+      : mOptions(std::move(options)) {
+    mPrefix = uniqueTempPath(mOptions.tempDirectory.empty()
+                                 ? std::filesystem::temp_directory_path()
+                                 : mOptions.tempDirectory,
+                             name);
+  }
+
+  ~SortedRuns() {
+    for (const std::filesystem::path &file : mFiles) {
+      std::error_code error;
+      std::filesystem::remove(file, error);
+    }
+  }
+
+  SortedRuns(const SortedRuns &) = delete;
+  SortedRuns &operator=(const SortedRuns &) = delete;
+
+  /// @brief Sorts @a records and writes them into a new run, leaving
+  ///  @a records empty.
+  /// @throws GameException if the run can not be written.
+  void add(std::vector<Record> &records) {
+    std::ranges::sort(records);
+    std::filesystem::path file;
+    {
+      const std::scoped_lock lock{mMutex};
+      file = mPrefix;
+      file += "." + std::to_string(mFiles.size()) + ".run";
+      mFiles.push_back(file);
+    }
+
+    std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+    std::vector<std::byte> bytes;
+    for (const Record &record : records) {
+      Format::append(bytes, record);
+      if (bytes.size() >= kWriteSize) {
+        writeBytes(stream, bytes);
+        bytes.clear();
+      }
+    }
+    writeBytes(stream, bytes);
+    stream.close();
+    if (!stream) {
+      throw GameException("Can't write " + file.string());
+    }
+    mRecords += records.size();
+    records.clear();
+  }
+
+  /// @brief Calls @a add(item, records) for every item below @a count on
+  ///  options.threads threads, to append the records of that item, and puts
+  ///  the records into runs as each worker's share of options.memory fills.
+  ///
+  /// Items are handed out in small blocks, so slow items do not hold the
+  /// other workers back. Once a worker fails, the others finish and its
+  /// exception is thrown again.
+  /// @return How many items @a add returned false for.
+  template <typename Add>
+  std::size_t fill(const std::size_t count, const Add &add) {
+    const int threads = threadCount(mOptions.threads);
+    const std::size_t run_size =
+        std::max<std::size_t>(1, mOptions.memory / sizeof(Record) /
+                                     static_cast<std::size_t>(threads));
+    std::atomic<std::size_t> next_item{0};
+    std::atomic<std::size_t> failed{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    const auto worker = [&] {
+      try {
+        std::vector<Record> records;
+        for (std::size_t first = next_item.fetch_add(kItemsPerTask);
+             first < count; first = next_item.fetch_add(kItemsPerTask)) {
+          const std::size_t last = std::min(first + kItemsPerTask, count);
+          for (std::size_t item = first; item < last; item++) {
+            if (!add(item, records)) {
+              failed++;
+            }
+            if (records.size() >= run_size) {
+              this->add(records);
+            }
+          }
+        }
+        if (!records.empty()) {
+          this->add(records);
+        }
+      } catch (...) {
+        const std::scoped_lock lock{error_mutex};
+        error = std::current_exception();
+      }
+    };
+    {
+      std::vector<std::jthread> pool;
+      for (int thread = 1; thread < threads; thread++) {
+        pool.emplace_back(worker);
+      }
+      worker();
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return failed;
+  }
+
+  /// @return The number of runs written.
+  [[nodiscard]] std::size_t size() const { return mFiles.size(); }
+
+  /// @return The number of records in all the runs.
+  [[nodiscard]] std::size_t records() const { return mRecords; }
+
+  /// @brief Calls @a visit with every record of every run, smallest first.
+  ///
+  /// The runs are mapped into memory and merged through a heap of their
+  /// next records, so only one record per run is held at a time.
+  /// @throws GameException if a run can not be read.
+  template <typename Visit> void merge(Visit &&visit) const {
+    std::vector<MappedFile> files;
+    files.reserve(mFiles.size());
+    for (const std::filesystem::path &file : mFiles) {
+      files.emplace_back(file);
+    }
+
+    struct Head {
+      Record record;
+      std::size_t run = 0;
+      std::size_t offset = 0;
+
+      bool operator>(const Head &other) const {
+        return other.record < record;
+      }
+    };
+    std::priority_queue<Head, std::vector<Head>, std::greater<>> heads;
+    for (std::size_t run = 0; run < files.size(); run++) {
+      if (files[run].bytes().size() >= Format::kSize) {
+        heads.push({.record = Format::read(files[run].bytes(), 0),
+                    .run = run,
+                    .offset = 0});
+      }
+    }
+
+    while (!heads.empty()) {
+      Head head = heads.top();
+      heads.pop();
+      visit(std::as_const(head.record));
+
+      head.offset += Format::kSize;
+      const std::span<const std::byte> bytes = files[head.run].bytes();
+      if (head.offset + Format::kSize <= bytes.size()) {
+        head.record = Format::read(bytes, head.offset);
+        heads.push(head);
+      }
+    }
+  }
+
+private:
+  /// Bytes written to a run at a time
+  static constexpr std::size_t kWriteSize = std::size_t{1} << 16;
+  /// Items handed to a worker at a time by fill()
+  static constexpr std::size_t kItemsPerTask = 64;
+
+  SortedRunsOptions mOptions;
+  std::filesystem::path mPrefix;
+  std::mutex mMutex;
+  std::vector<std::filesystem::path> mFiles;
+  std::atomic<std::size_t> mRecords{0};
+};
+} // namespace chess
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace chess {
+/// @return A path in @a directory named like @a name with a random number
+///  before its extension, e.g. "games.1234567.pgn", so that programs running
+///  at the same time do not write to the same file.
+[[nodiscard]] inline std::filesystem::path
+uniqueTempPath(const std::filesystem::path &directory,
+               const std::string_view name) {
+  std::random_device random;
+  const std::uint64_t suffix =
+      (static_cast<std::uint64_t>(random()) << 32) | random();
+  const std::filesystem::path file{name};
+  return directory / (file.stem().string() + "." + std::to_string(suffix) +
+                      file.extension().string());
+}
+} // namespace chess
@@ -0,0 +1,47 @@
+#include "test_utility.hpp"
+#include "game.hpp"
+#include "validation.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace chess::test {
+void playTestMove(chess::Game &game, const std::string &move) {
+  const auto [from, to] = chess::parseMove(move);
+  chess::EnPassant S_enPassant;
+  chess::Castling S_castling;
+  chess::Promotion S_promotion;
+  REQUIRE(chess::isMoveValid(game, from, to, S_enPassant, S_castling,
+                             S_promotion));
+  if (S_promotion.bApplied) {
+    S_promotion.chBefore = *game.getPieceAtPosition(from);
+    S_promotion.chAfter = {chess::Piece::kQueen, game.getCurrentTurn()};
+  }
+  game.movePiece(from, to, S_enPassant, S_castling, S_promotion);
+}
+
+namespace {
+/// validateMove() drops the promotion of a move that is not one
+chess::Move toLegalMove(const std::string &move,
+                        const chess::Piece promotion) {
+  const auto [from, to] = chess::parseMove(move);
+  return chess::Move{from, to, chess::MoveFlag::kPromotion, promotion};
+}
+} // namespace
+
+void playLegalMove(chess::Game &game, const std::string &move,
+                   const chess::Piece promotion) {
+  const chess::MoveValidation result =
+      chess::validateMove(game, toLegalMove(move, promotion));
+  REQUIRE(result.valid());
+  game.playMove(result.move);
+}
+
+void playLegalMove(chess::GameState &state, const std::string &move,
+                   const chess::Piece promotion) {
+  const chess::MoveValidation result =
+      chess::validateMove(state, toLegalMove(move, promotion));
+  REQUIRE(result.valid());
+  state.makeMove(result.move);
+}
+
+} // namespace chess::test
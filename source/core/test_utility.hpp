@@ -0,0 +1,28 @@
+#pragma once
+
+#include "pieces.hpp"
+
+#include <string>
+
+namespace chess {
+class Game;
+class GameState;
+} // namespace chess
+
+namespace chess::test {
+/// Plays the move written as @a move, e.g. "E2-E4", through
+/// Game::movePiece() the way the console does, failing the test if
+/// isMoveValid() rejects it. Pawns reaching the last row become queens.
+void playTestMove(chess::Game &game, const std::string &move);
+
+/// Plays the move written as @a move with Game::playMove(), failing the test
+/// if validateMove() rejects it. Pawns reaching the last row become
+/// @a promotion.
+void playLegalMove(chess::Game &game, const std::string &move,
+                   chess::Piece promotion = chess::Piece::kQueen);
+
+/// Same as playLegalMove(chess::Game &, ...), for a bare position.
+void playLegalMove(chess::GameState &state, const std::string &move,
+                   chess::Piece promotion = chess::Piece::kQueen);
+
+} // namespace chess::test
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+
+namespace chess {
+/// @return @a threads if positive, otherwise one thread per hardware thread.
+[[nodiscard]] inline int threadCount(const int threads) {
+  const int hardware = static_cast<int>(std::thread::hardware_concurrency());
+  return threads > 0 ? threads : std::max(1, hardware);
+}
+} // namespace chess
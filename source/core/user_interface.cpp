@@ -2,6 +2,7 @@
 #include "board.hpp"
 
 #include <cassert>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <map>
@@ -55,7 +56,8 @@ void printLogo(void) {
 
 void printMenu(void) {
   std::cout
-      << "Commands: (N)ew game\t(M)ove \t(U)ndo \t(S)ave \t(L)oad \t(Q)uit \n";
+      << "Commands: (N)ew game\t(M)ove \t(U)ndo \t(S)ave \t(L)oad \t(F)EN "
+         "\t(H)int \t(Q)uit \n";
 }
 
 void printMessage(void) {
@@ -125,9 +127,12 @@ void printSituation(const Game &game) {
         space = " ";
       }
 
-      std::cout << space << iMoves << " ..... "
-                << game.rounds[iMoves - 1].white_move.c_str() << " | "
-                << game.rounds[iMoves - 1].black_move.c_str() << "\n";
+      const Game::Round &round = game.rounds[iMoves - 1];
+      std::cout << space << iMoves << " ..... " << std::left << std::setw(7)
+                << (round.white_move ? toString(*round.white_move) : "...")
+                << " | "
+                << (round.black_move ? toString(*round.black_move) : "")
+                << "\n";
       iMoves--;
     }
 
@@ -196,7 +201,7 @@ Position toPosition(const std::string &move) {
 }
 
 void printBoardDebug(const Game &game) {
-  const Board::BoardArray &board = game.board().boardState();
+  const Board::BoardArray board = game.board().boardState();
   std::copy(board.cbegin(), board.cend(),
             std::ostream_iterator<SquareState>(std::cout, ", "));
 }
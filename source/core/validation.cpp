@@ -1,319 +1,348 @@
 #include "validation.hpp"
+#include "attacks.hpp"
 #include "chess.hpp"
 #include "game.hpp"
-#include "user_interface.hpp"
+#include "logic.hpp"
+#include "movegen.hpp"
 
 #include <cassert>
-#include <iostream>
 
 namespace chess {
-bool isMoveValid(const Game &current_game, const Position present,
-                 const Position future, chess::EnPassant &S_enPassant,
-                 chess::Castling &S_castling, chess::Promotion &S_promotion) {
-  bool bValid = false;
+namespace {
+MoveValidation validatePawnMove(const GameState &state,
+                                const CheckInfo &checkInfo, const Move move) {
+  const Board &board = state.board();
+  const Side side = state.sideToMove();
+  const Bitboard occupied = board.occupied();
+  const int from = move.fromSquare();
+  const int to = move.toSquare();
+  const int forward = side == Side::kWhite ? kNumCols : -kNumCols;
+  const int initialRow = side == Side::kWhite ? 1 : 6;
+
+  MoveFlag flag = MoveFlag::kNormal;
+  bool reachable = false;
+  if (to == from + forward) {
+    reachable = !testSquare(occupied, to);
+  } else if (to == from + 2 * forward) {
+    reachable = from / kNumCols == initialRow &&
+                !testSquare(occupied, from + forward) &&
+                !testSquare(occupied, to);
+  } else if (testSquare(pawnAttacks(side, from), to)) {
+    if (testSquare(board.pieces(opponentSide(side)), to)) {
+      reachable = true;
+    } else if (state.enPassantSquare() == to) {
+      reachable = true;
+      flag = MoveFlag::kEnPassant;
+    }
+  }
+  if (!reachable) {
+    return {.move = move, .error = MoveError::kUnreachable};
+  }
 
-  const SquareState piece = current_game.getPieceAtPosition(present);
-  assert(piece.has_value());
+  if (flag == MoveFlag::kEnPassant) {
+    const Move capture{move.from(), move.to(), flag};
+    return {.move = capture,
+            .error = isLegalEnPassant(board, capture, side)
+                         ? MoveError::kNone
+                         : MoveError::kKingInCheck};
+  }
 
-  // ----------------------------------------------------
-  // 1. Is the piece  allowed to move in that direction?
-  // ----------------------------------------------------
-  switch (piece->mPiece) {
-  case Piece::kPawn: {
-    // Wants to move forward
-    if (future.iColumn == present.iColumn) {
-      // Simple move forward
-      if ((chess::isWhitePiece(*piece) && future.iRow == present.iRow + 1) ||
-          (chess::isBlackPiece(*piece) && future.iRow == present.iRow - 1)) {
-        if (!current_game.getPieceAtPosition(future)) {
-          bValid = true;
-        }
-      }
-
-      // Double move forward
-      else if ((chess::isWhitePiece(*piece) &&
-                future.iRow == present.iRow + 2) ||
-               (chess::isBlackPiece(*piece) &&
-                future.iRow == present.iRow - 2)) {
-        // This is only allowed if the pawn is in its original place
-        if (chess::isWhitePiece(*piece)) {
-          if (!current_game.getPieceAtPosition(
-                  {future.iRow - 1, future.iColumn}) &&
-              !current_game.getPieceAtPosition(future) && 1 == present.iRow) {
-            bValid = true;
-          }
-        } else // if ( isBlackPiece(piece) )
-        {
-          if (!current_game.getPieceAtPosition(
-                  {future.iRow + 1, future.iColumn}) &&
-              !current_game.getPieceAtPosition(future) && 6 == present.iRow) {
-            bValid = true;
-          }
-        }
-      } else {
-        // This is invalid
-        return false;
-      }
-    }
+  const int lastRow = side == Side::kWhite ? kNumRows - 1 : 0;
+  const Move played =
+      to / kNumCols == lastRow
+          ? Move{move.from(), move.to(), MoveFlag::kPromotion,
+                 move.flag() == MoveFlag::kPromotion ? move.promotion()
+                                                     : Piece::kQueen}
+          : Move{move.from(), move.to()};
+  return {.move = played,
+          .error = testSquare(checkInfo.checkMask() & checkInfo.pinRay(from),
+                              to)
+                       ? MoveError::kNone
+                       : MoveError::kKingInCheck};
+}
 
-    // The "en passant" move
-    else if ((chess::isWhitePiece(*piece) && 4 == present.iRow &&
-              5 == future.iRow && 1 == abs(future.iColumn - present.iColumn)) ||
-             (chess::isBlackPiece(*piece) && 3 == present.iRow &&
-              2 == future.iRow && 1 == abs(future.iColumn - present.iColumn))) {
-      // It is only valid if last move of the opponent was a double move forward
-      // by a pawn on a adjacent column
-      const std::string last_move = current_game.getLastMove();
-
-      // Parse the line
-      const auto [LastMoveFrom, LastMoveTo] = parseMove(last_move);
-
-      // First of all, was it a pawn?
-      const SquareState chLstMvPiece =
-          current_game.getPieceAtPosition(LastMoveTo);
-
-      if (!chLstMvPiece.has_value() || chLstMvPiece->mPiece != Piece::kPawn) {
-        return false;
-      }
-
-      // Did the pawn have a double move forward and was it an adjacent column?
-      if (2 == abs(LastMoveTo.iRow - LastMoveFrom.iRow) &&
-          1 == abs(LastMoveFrom.iColumn - present.iColumn)) {
-        std::cout << "En passant move!\n";
-        bValid = true;
-
-        S_enPassant.bApplied = true;
-        S_enPassant.PawnCaptured.iRow = LastMoveTo.iRow;
-        S_enPassant.PawnCaptured.iColumn = LastMoveTo.iColumn;
-      }
-    }
+MoveValidation validateKingMove(const GameState &state,
+                                const CheckInfo &checkInfo, const Move move) {
+  const Board &board = state.board();
+  const Side side = state.sideToMove();
+  const Side opponent = opponentSide(side);
+  const int from = move.fromSquare();
+  const int to = move.toSquare();
+
+  if (testSquare(kingAttacks(from), to)) {
+    // Sliders see through the king, or it could step back along a check
+    const Bitboard occupied = board.occupied() & ~squareBit(from);
+    return {.move = Move{move.from(), move.to()},
+            .error = isSquareAttacked(board, to, opponent, occupied)
+                         ? MoveError::kKingInCheck
+                         : MoveError::kNone};
+  }
 
-    // Wants to capture a piece
-    else if (1 == abs(future.iColumn - present.iColumn)) {
-      if ((chess::isWhitePiece(*piece) && future.iRow == present.iRow + 1) ||
-          (chess::isBlackPiece(*piece) && future.iRow == present.iRow - 1)) {
-        // Only allowed if there is something to be captured in the square
-        if (current_game.getPieceAtPosition(future)) {
-          bValid = true;
-          std::cout << "Pawn captured a piece!\n";
-        }
-      }
-    } else {
-      // This is invalid
-      return false;
-    }
+  // Castling: two columns along the home row, from the king's own square
+  const int row = side == Side::kWhite ? 0 : kNumRows - 1;
+  const Position home{.iRow = row, .iColumn = 4};
+  if (from != positionToSquare(home) || to / kNumCols != row ||
+      abs(to - from) != 2) {
+    return {.move = move, .error = MoveError::kUnreachable};
+  }
+  const Move castling{move.from(), move.to(), MoveFlag::kCastling};
+  const BoardSide boardSide =
+      to > from ? BoardSide::KING_SIDE : BoardSide::QUEEN_SIDE;
+  const Position rook{.iRow = row,
+                      .iColumn = boardSide == BoardSide::KING_SIDE ? 7 : 0};
+  if (!state.castlingAllowed(boardSide, side) ||
+      board(rook) != PieceWithSide{Piece::kRook, side}) {
+    return {.move = castling, .error = MoveError::kCastlingNotAllowed};
+  }
+  if (squaresBetween(from, positionToSquare(rook)) & board.occupied()) {
+    return {.move = castling, .error = MoveError::kUnreachable};
+  }
 
-    // If a pawn reaches its eight rank, it must be promoted to another piece
-    if ((chess::isWhitePiece(*piece) && 7 == future.iRow) ||
-        (chess::isBlackPiece(*piece) && 0 == future.iRow)) {
-      std::cout << "Pawn must be promoted!\n";
-      S_promotion.bApplied = true;
-    }
-  } break;
-
-  case Piece::kRook: {
-    // Horizontal move
-    if ((future.iRow == present.iRow) && (future.iColumn != present.iColumn)) {
-      // Check if there are no pieces on the way
-      if (current_game.isPathFree(present, future,
-                                  chess::Direction::HORIZONTAL)) {
-        bValid = true;
-      }
-    }
-    // Vertical move
-    else if ((future.iRow != present.iRow) &&
-             (future.iColumn == present.iColumn)) {
-      // Check if there are no pieces on the way
-      if (current_game.isPathFree(present, future,
-                                  chess::Direction::VERTICAL)) {
-        bValid = true;
-      }
-    }
-  } break;
+  // The king may neither castle out of check nor pass through or land on an
+  // attacked square
+  const int skipped = (from + to) / 2;
+  if (checkInfo.checkers() != kEmptyBitboard ||
+      isSquareAttacked(board, skipped, opponent) ||
+      isSquareAttacked(board, to, opponent)) {
+    return {.move = castling, .error = MoveError::kKingInCheck};
+  }
+  return {.move = castling};
+}
 
-  case Piece::kKnight: {
-    if ((2 == abs(future.iRow - present.iRow)) &&
-        (1 == abs(future.iColumn - present.iColumn))) {
-      bValid = true;
-    }
+MoveValidation validate(const GameState &state, const CheckInfo &checkInfo,
+                        const Move move) {
+  const Board &board = state.board();
+  const Side side = state.sideToMove();
+  const SquareState piece = board(move.from());
+  if (!piece) {
+    return {.move = move, .error = MoveError::kEmptySquare};
+  }
+  if (getPieceSide(*piece) != side) {
+    return {.move = move, .error = MoveError::kOpponentPiece};
+  }
+  const int from = move.fromSquare();
+  const int to = move.toSquare();
+  if (testSquare(board.pieces(side), to)) {
+    return {.move = move, .error = MoveError::kOwnPieceOnTarget};
+  }
 
-    else if ((1 == abs(future.iRow - present.iRow)) &&
-             (2 == abs(future.iColumn - present.iColumn))) {
-      bValid = true;
-    }
-  } break;
-
-  case Piece::kBishop: {
-    // Diagonal move
-    if (abs(future.iRow - present.iRow) ==
-        abs(future.iColumn - present.iColumn)) {
-      // Check if there are no pieces on the way
-      if (current_game.isPathFree(present, future,
-                                  chess::Direction::DIAGONAL)) {
-        bValid = true;
-      }
-    }
-  } break;
-
-  case Piece::kQueen: {
-    // Horizontal move
-    if ((future.iRow == present.iRow) && (future.iColumn != present.iColumn)) {
-      // Check if there are no pieces on the way
-      if (current_game.isPathFree(present, future,
-                                  chess::Direction::HORIZONTAL)) {
-        bValid = true;
-      }
-    }
-    // Vertical move
-    else if ((future.iRow != present.iRow) &&
-             (future.iColumn == present.iColumn)) {
-      // Check if there are no pieces on the way
-      if (current_game.isPathFree(present, future,
-                                  chess::Direction::VERTICAL)) {
-        bValid = true;
-      }
-    }
+  const Bitboard occupied = board.occupied();
+  Bitboard reach = kEmptyBitboard;
+  switch (piece->mPiece) {
+  case Piece::kPawn:
+    return validatePawnMove(state, checkInfo, move);
+  case Piece::kKing:
+    return validateKingMove(state, checkInfo, move);
+  case Piece::kKnight:
+    reach = knightAttacks(from);
+    break;
+  case Piece::kBishop:
+    reach = bishopAttacks(from, occupied);
+    break;
+  case Piece::kRook:
+    reach = rookAttacks(from, occupied);
+    break;
+  case Piece::kQueen:
+    reach = queenAttacks(from, occupied);
+    break;
+  }
 
-    // Diagonal move
-    else if (abs(future.iRow - present.iRow) ==
-             abs(future.iColumn - present.iColumn)) {
-      // Check if there are no pieces on the way
-      if (current_game.isPathFree(present, future,
-                                  chess::Direction::DIAGONAL)) {
-        bValid = true;
-      }
-    }
-  } break;
+  const Move played{move.from(), move.to()};
+  if (!testSquare(reach, to)) {
+    return {.move = played, .error = MoveError::kUnreachable};
+  }
+  // Resolves a check, if any, and keeps a pinned piece on its pin ray
+  if (!testSquare(checkInfo.checkMask() & checkInfo.pinRay(from), to)) {
+    return {.move = played, .error = MoveError::kKingInCheck};
+  }
+  return {.move = played};
+}
+} // namespace
 
-  case Piece::kKing: {
-    // Horizontal move by 1
-    if ((future.iRow == present.iRow) &&
-        (1 == abs(future.iColumn - present.iColumn))) {
-      bValid = true;
-    }
+MoveValidation validateMove(const GameState &state, const Move move) {
+  return validate(state, CheckInfo{state.board(), state.sideToMove()}, move);
+}
 
-    // Vertical move by 1
-    else if ((future.iColumn == present.iColumn) &&
-             (1 == abs(future.iRow - present.iRow))) {
-      bValid = true;
-    }
+MoveValidation validateMove(const Game &game, const Move move) {
+  return validate(game.state(), game.checkInfo(), move);
+}
 
-    // Diagonal move by 1
-    else if ((1 == abs(future.iRow - present.iRow)) &&
-             (1 == abs(future.iColumn - present.iColumn))) {
-      bValid = true;
-    }
+void validateMoves(const GameState &state, const std::span<const Move> moves,
+                   const std::span<MoveValidation> results) {
+  assert(results.size() >= moves.size());
+  const CheckInfo checkInfo{state.board(), state.sideToMove()};
+  for (std::size_t i = 0; i < moves.size(); ++i) {
+    results[i] = validate(state, checkInfo, moves[i]);
+  }
+}
 
-    // Castling
-    else if ((future.iRow == present.iRow) &&
-             (2 == abs(future.iColumn - present.iColumn))) {
-      // Castling is only allowed in these circunstances:
-
-      // 1. King is not in check
-      if (true == current_game.playerKingInCheck()) {
-        return false;
-      }
-
-      // 2. No pieces in between the king and the rook
-      if (false == current_game.isPathFree(present, future,
-                                           chess::Direction::HORIZONTAL)) {
-        return false;
-      }
-
-      // 3. King and rook must not have moved yet;
-      // 4. King must not pass through a square that is attacked by an enemy
-      // piece
-      if (future.iColumn > present.iColumn) {
-        // if future.iColumn is greather, it means king side
-        if (false ==
-            current_game.castlingAllowed(chess::BoardSide::KING_SIDE,
-                                         chess::getPieceSide(*piece))) {
-          createNextMessage("Castling to the king side is not allowed.\n");
-          return false;
-        } else {
-          // Check if the square that the king skips is not under attack
-          chess::UnderAttack square_skipped =
-              current_game.isUnderAttack({present.iRow, present.iColumn + 1},
-                                         current_game.getCurrentTurn());
-          if (false == square_skipped.bUnderAttack) {
-            // Fill the S_castling structure
-            S_castling.bApplied = true;
-
-            // Present position of the rook
-            S_castling.rook_before.iRow = present.iRow;
-            S_castling.rook_before.iColumn = present.iColumn + 3;
-
-            // Future position of the rook
-            S_castling.rook_after.iRow = future.iRow;
-            S_castling.rook_after.iColumn =
-                present.iColumn + 1; // future.iColumn -1
-
-            bValid = true;
-          }
-        }
-      } else // if (future.iColumn < present.iColumn)
-      {
-        // if present.iColumn is greather, it means queen side
-        if (!current_game.castlingAllowed(BoardSide::QUEEN_SIDE,
-                                          getPieceSide(*piece))) {
-          createNextMessage("Castling to the queen side is not allowed.\n");
-          return false;
-        } else {
-          // Check if the square that the king skips is not attacked
-          chess::UnderAttack square_skipped =
-              current_game.isUnderAttack({present.iRow, present.iColumn - 1},
-                                         current_game.getCurrentTurn());
-          if (false == square_skipped.bUnderAttack) {
-            // Fill the S_castling structure
-            S_castling.bApplied = true;
-
-            // Present position of the rook
-            S_castling.rook_before.iRow = present.iRow;
-            S_castling.rook_before.iColumn = present.iColumn - 4;
-
-            // Future position of the rook
-            S_castling.rook_after.iRow = future.iRow;
-            S_castling.rook_after.iColumn =
-                present.iColumn - 1; // future.iColumn +1
-
-            bValid = true;
-          }
-        }
-      }
-    }
-  } break;
+std::string_view describe(const MoveError error) {
+  switch (error) {
+  case MoveError::kNone:
+    return "Move is valid";
+  case MoveError::kEmptySquare:
+    return "There is no piece on that square";
+  case MoveError::kOpponentPiece:
+    return "That piece belongs to the opponent";
+  case MoveError::kOwnPieceOnTarget:
+    return "Position is already taken by a piece of the same color";
+  case MoveError::kUnreachable:
+    return "Piece can not move to that square";
+  case MoveError::kCastlingNotAllowed:
+    return "Castling to that side is not allowed";
+  case MoveError::kKingInCheck:
+    return "Move would put player's king in check";
+  }
+  return "";
+}
 
-  default:
-    std::cout << "!!!!Should not reach here. \n\n\n";
+void fillMoveDetails(const Move &move, EnPassant &S_enPassant,
+                     Castling &S_castling, Promotion &S_promotion) {
+  const Position from = move.from();
+  const Position to = move.to();
+  switch (move.flag()) {
+  case MoveFlag::kNormal:
+    break;
+  case MoveFlag::kEnPassant:
+    S_enPassant.bApplied = true;
+    S_enPassant.PawnCaptured = {.iRow = from.iRow, .iColumn = to.iColumn};
+    break;
+  case MoveFlag::kCastling:
+    S_castling.bApplied = true;
+    S_castling.rook_before = {.iRow = from.iRow,
+                              .iColumn = to.iColumn > from.iColumn ? 7 : 0};
+    S_castling.rook_after = {.iRow = from.iRow,
+                             .iColumn = (from.iColumn + to.iColumn) / 2};
+    break;
+  case MoveFlag::kPromotion:
+    S_promotion.bApplied = true;
     break;
   }
+}
 
-  // If it is a move in an invalid direction, do not even bother to check the
-  // rest
-  if (!bValid) {
-    std::cout << "Piece is not allowed to move to that square\n";
+bool isMoveValid(const Game &current_game, const Position present,
+                 const Position future, chess::EnPassant &S_enPassant,
+                 chess::Castling &S_castling, chess::Promotion &S_promotion) {
+  const MoveValidation result =
+      validateMove(current_game, Move{present, future});
+  if (!result.valid()) {
     return false;
   }
+  fillMoveDetails(result.move, S_enPassant, S_castling, S_promotion);
+  return true;
+}
+} // namespace chess
+
+#if defined(UNIT_TEST)
+
+#include "test_utility.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace {
+chess::Move toMove(const std::string &text) {
+  const auto [from, to] = chess::parseMove(text);
+  return chess::Move{from, to};
+}
 
-  // -------------------------------------------------------------------------
-  // 2. Is there another piece of the same color on the destination square?
-  // -------------------------------------------------------------------------
-  if (current_game.isSquareOccupied(future)) {
-    if (const SquareState chAuxPiece = current_game.getPieceAtPosition(future);
-        chAuxPiece && getPieceSide(*piece) == getPieceSide(*chAuxPiece)) {
-      std::cout << "Position is already taken by a piece of the same color\n";
-      return false;
+} // namespace
+
+TEST_CASE("validateMove") {
+  using chess::MoveError;
+  chess::GameState state;
+
+  SECTION("Errors") {
+    CHECK(chess::validateMove(state, toMove("E2-E4")).valid());
+    CHECK(chess::validateMove(state, toMove("E2-E5")).error ==
+          MoveError::kUnreachable);
+    CHECK(chess::validateMove(state, toMove("F1-B5")).error ==
+          MoveError::kUnreachable);
+    CHECK(chess::validateMove(state, toMove("E1-E2")).error ==
+          MoveError::kOwnPieceOnTarget);
+    CHECK(chess::validateMove(state, toMove("E7-E5")).error ==
+          MoveError::kOpponentPiece);
+    CHECK(chess::validateMove(state, toMove("E4-E5")).error ==
+          MoveError::kEmptySquare);
+  }
+  SECTION("Check") {
+    for (const char *move : {"E2-E4", "F7-F6", "D2-D4", "G7-G5", "D1-H5"}) {
+      chess::test::playLegalMove(state, move);
     }
+    CHECK(chess::validateMove(state, toMove("A7-A6")).error ==
+          MoveError::kKingInCheck);
+    CHECK(chess::validateMove(state, toMove("E8-F7")).error ==
+          MoveError::kKingInCheck);
   }
+  SECTION("Castling") {
+    for (const char *move :
+         {"E2-E4", "E7-E5", "G1-F3", "B8-C6", "F1-C4", "G8-F6"}) {
+      chess::test::playLegalMove(state, move);
+    }
+    const chess::MoveValidation result =
+        chess::validateMove(state, toMove("E1-G1"));
+    CHECK(result.valid());
+    CHECK(result.move.flag() == chess::MoveFlag::kCastling);
+
+    chess::test::playLegalMove(state, "H1-G1");
+    chess::test::playLegalMove(state, "F8-E7");
+    chess::test::playLegalMove(state, "G1-H1");
+    chess::test::playLegalMove(state, "E8-G8");
+    CHECK(chess::validateMove(state, toMove("E1-G1")).error ==
+          MoveError::kCastlingNotAllowed);
+  }
+  SECTION("Promotion") {
+    for (const char *move : {"H2-H4", "G7-G5", "H4-G5", "H7-H6", "G5-H6",
+                             "E7-E6", "H6-H7", "F8-E7"}) {
+      chess::test::playLegalMove(state, move);
+    }
+    const chess::MoveValidation queen =
+        chess::validateMove(state, toMove("H7-G8"));
+    CHECK(queen.move.flag() == chess::MoveFlag::kPromotion);
+    CHECK(queen.move.promotion() == chess::Piece::kQueen);
+
+    const chess::MoveValidation knight = chess::validateMove(
+        state, chess::Move{chess::Position{6, 7}, chess::Position{7, 6},
+                           chess::MoveFlag::kPromotion, chess::Piece::kKnight});
+    CHECK(knight.valid());
+    CHECK(knight.move.promotion() == chess::Piece::kKnight);
+  }
+}
 
-  // ----------------------------------------------
-  // 3. Would the king be in check after the move?
-  // ----------------------------------------------
-  if (current_game.wouldKingBeInCheck(*piece, present, future, S_enPassant)) {
-    std::cout << "Move would put player's king in check\n";
-    return false;
+TEST_CASE("validateMoves matches validateMove") {
+  chess::GameState state;
+  for (const char *move : {"E2-E4", "D7-D5", "E4-E5", "F7-F5", "D1-H5"}) {
+    chess::test::playLegalMove(state, move);
   }
 
-  return bValid;
+  std::vector<chess::Move> moves;
+  for (int from = 0; from < chess::kNumPositions; ++from) {
+    for (int to = 0; to < chess::kNumPositions; ++to) {
+      moves.push_back(chess::Move{chess::squareToPosition(from),
+                                  chess::squareToPosition(to)});
+    }
+  }
+  std::vector<chess::MoveValidation> results(moves.size());
+
+  // Validation never prints
+  std::ostringstream output;
+  std::streambuf *const previous = std::cout.rdbuf(output.rdbuf());
+  chess::validateMoves(state, moves, results);
+  std::cout.rdbuf(previous);
+  CHECK(output.str().empty());
+
+  int valid = 0;
+  for (std::size_t i = 0; i < moves.size(); ++i) {
+    const chess::MoveValidation single = chess::validateMove(state, moves[i]);
+    CHECK(results[i].move == single.move);
+    CHECK(results[i].error == single.error);
+    valid += single.valid() ? 1 : 0;
+  }
+  // The queen on h5 checks the king: only g7-g6 and Kd7 answer it
+  CHECK(valid == 2);
 }
-} // namespace chess
\ No newline at end of file
+
+#endif
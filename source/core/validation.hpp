@@ -1,12 +1,66 @@
 #pragma once
 
 #include "board.hpp"
+#include "move.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
 
 namespace chess {
 struct EnPassant;
 struct Castling;
 struct Promotion;
 class Game;
+class GameState;
+
+/// Why validateMove() rejected a move
+enum struct MoveError : std::uint8_t {
+  kNone,
+  kEmptySquare,
+  kOpponentPiece,
+  kOwnPieceOnTarget,
+  kUnreachable,
+  kCastlingNotAllowed,
+  kKingInCheck
+};
+
+/// The outcome of validateMove()
+struct MoveValidation {
+  /// The move as it is to be played, with the MoveFlag of an en passant
+  /// capture, castling or promotion filled in.
+  Move move;
+  MoveError error = MoveError::kNone;
+
+  [[nodiscard]] bool valid() const { return error == MoveError::kNone; }
+};
+
+/// @brief Checks whether the side to move in @a state may play @a move.
+///
+/// Only the squares of @a move and, for a promotion, its piece are looked at;
+/// the flag is worked out from the position. A pawn reaching the last row
+/// becomes a queen unless @a move asks for another piece. Nothing is printed
+/// and @a state is not changed.
+[[nodiscard]] MoveValidation validateMove(const GameState &state, Move move);
+
+/// Same as validateMove(const GameState &, Move), reusing the checks and pins
+/// @a game already keeps.
+[[nodiscard]] MoveValidation validateMove(const Game &game, Move move);
+
+/// @brief Validates every move of @a moves into the matching element of
+///  @a results, finding the checks and pins of @a state only once.
+///
+/// @a results must be at least as long as @a moves.
+void validateMoves(const GameState &state, std::span<const Move> moves,
+                   std::span<MoveValidation> results);
+
+/// @return A sentence explaining @a error to the player.
+[[nodiscard]] std::string_view describe(MoveError error);
+
+/// Fills the structs Game::movePiece() takes for @a move, a move returned by
+/// validateMove(). The promoted piece itself is left to the caller.
+void fillMoveDetails(const Move &move, EnPassant &S_enPassant,
+                     Castling &S_castling, Promotion &S_promotion);
 
 bool isMoveValid(const Game &current_game, const Position present,
                  const Position future, chess::EnPassant &S_enPassant,
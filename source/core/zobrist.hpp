@@ -0,0 +1,76 @@
+#pragma once
+
+#include "chess.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace chess::zobrist {
+/// 64-bit position key, see Game::hash().
+using Key = std::uint64_t;
+
+namespace detail {
+constexpr int kPieceKeys = 2 * 6 * kNumPositions;
+constexpr int kCastlingKeysOffset = kPieceKeys;
+constexpr int kEnPassantKeysOffset = kCastlingKeysOffset + 4;
+constexpr int kSideKeyOffset = kEnPassantKeysOffset + kNumCols;
+constexpr int kNumKeys = kSideKeyOffset + 1;
+
+/// SplitMix64, used only to fill the key table at compile time.
+constexpr std::uint64_t splitMix64(std::uint64_t &state) {
+  std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+constexpr std::array<Key, kNumKeys> makeKeys() {
+  std::array<Key, kNumKeys> keys{};
+  std::uint64_t state = 0x43686573734B6579ULL;
+  for (Key &key : keys) {
+    key = splitMix64(state);
+  }
+  return keys;
+}
+
+inline constexpr std::array<Key, kNumKeys> kKeys = makeKeys();
+} // namespace detail
+
+/// @return The key of @a piece standing on the linear square @a square.
+[[nodiscard]] constexpr Key pieceKey(const PieceWithSide piece,
+                                     const int square) {
+  const int kind =
+      static_cast<int>(piece.mSide) * 6 + static_cast<int>(piece.mPiece);
+  return detail::kKeys[kind * kNumPositions + square];
+}
+
+/// @return The key toggled while @a side may still castle on @a board_side.
+[[nodiscard]] constexpr Key castlingKey(const Side side,
+                                        const BoardSide board_side) {
+  const int index = static_cast<int>(side) * 2 +
+                    (board_side == BoardSide::KING_SIDE ? 0 : 1);
+  return detail::kKeys[detail::kCastlingKeysOffset + index];
+}
+
+/// @return The keys of all the rights set in @a rights, combined.
+[[nodiscard]] constexpr Key castlingKey(const CastlingRights rights) {
+  Key key = 0;
+  for (int index = 0; index < 4; index++) {
+    if (rights & (1 << index)) {
+      key ^= detail::kKeys[detail::kCastlingKeysOffset + index];
+    }
+  }
+  return key;
+}
+
+/// @return The key toggled while an en passant capture on @a file is possible.
+[[nodiscard]] constexpr Key enPassantKey(const int file) {
+  return detail::kKeys[detail::kEnPassantKeysOffset + file];
+}
+
+/// @return The key toggled while black is to move.
+[[nodiscard]] constexpr Key sideKey() {
+  return detail::kKeys[detail::kSideKeyOffset];
+}
+
+} // namespace chess::zobrist
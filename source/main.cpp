@@ -1,10 +1,13 @@
 #include "chess.hpp"
 #include "load_save.hpp"
+#include "opening_book.hpp"
 #include "user_interface.hpp"
 #include "validation.hpp"
 
 #include <cassert>
 #include <iostream>
+#include <optional>
+#include <random>
 
 namespace chess {
 
@@ -17,6 +20,46 @@ void undoMove(chess::Game &current_game) {
   createNextMessage("Last move was undone\n");
 }
 
+void showHint(const chess::Game &current_game,
+              std::optional<chess::OpeningBook> &book,
+              std::mt19937_64 &random) {
+  if (!book) {
+    std::cout << "Type the opening book to use (" << kBookExtension
+              << " in the Polyglot format): ";
+    std::string file_name;
+    getline(std::cin, file_name);
+    try {
+      book.emplace(file_name);
+    } catch (const GameException &err) {
+      createNextMessage(std::string{err.what()} + "\n");
+      return;
+    }
+  }
+
+  const std::vector<BookMove> moves = book->moves(current_game.state());
+  if (moves.empty()) {
+    createNextMessage("The book has no move for this position\n");
+    return;
+  }
+  unsigned total = 0;
+  for (const BookMove &book_move : moves) {
+    total += book_move.weight;
+  }
+  std::string message = "Book moves: ";
+  for (const BookMove &book_move : moves) {
+    if (&book_move != &moves.front()) {
+      message += ", ";
+    }
+    message += toString(book_move.move);
+    if (total > 0) {
+      message += " (" + std::to_string(100 * book_move.weight / total) + "%)";
+    }
+  }
+  message += "\nThe book suggests " +
+             toString(*book->pickMove(current_game.state(), random())) + "\n";
+  createNextMessage(message);
+}
+
 void movePiece(chess::Game &current_game) {
   // Get user input for the piece they want to move
   std::cout << "Choose piece to be moved. (example: A1 or b2): ";
@@ -29,11 +72,6 @@ void movePiece(chess::Game &current_game) {
     return;
   }
 
-  std::string to_record;
-  to_record += move_from[0];
-  to_record += move_from[1];
-  to_record += "-";
-
   const Position present = toPosition(move_from);
 
   const SquareState piece = current_game.getPieceAtPosition(present);
@@ -65,10 +103,6 @@ void movePiece(chess::Game &current_game) {
     return;
   }
 
-  // Put in the std::string to be logged
-  to_record += move_to[0];
-  to_record += move_to[1];
-
   const Position future = toPosition(move_to);
   // Check if it is not the exact same square
   if (future == present) {
@@ -81,11 +115,14 @@ void movePiece(chess::Game &current_game) {
   chess::Castling S_castling = {0};
   chess::Promotion S_promotion = {0};
 
-  if (!isMoveValid(current_game, present, future, S_enPassant, S_castling,
-                   S_promotion)) {
-    createNextMessage("[Invalid] Piece can not move to that square!\n");
+  const chess::MoveValidation validation =
+      validateMove(current_game, chess::Move{present, future});
+  if (!validation.valid()) {
+    createNextMessage("[Invalid] " + std::string{describe(validation.error)} +
+                      "!\n");
     return;
   }
+  fillMoveDetails(validation.move, S_enPassant, S_castling, S_promotion);
 
   // ---------------------------------------------------
   // Promotion: user most choose a piece to
@@ -116,17 +153,8 @@ void movePiece(chess::Game &current_game) {
     } else {
       S_promotion.chAfter = charToPiece(tolower(chPromoted));
     }
-
-    to_record += '=';
-    to_record += toupper(chPromoted); // always log with a capital letter
   }
 
-  // ---------------------------------------------------
-  // Log the move: do it prior to making the move
-  // because we need the getCurrentTurn()
-  // ---------------------------------------------------
-  current_game.logMove(to_record);
-
   // ---------------------------------------------------
   // Make the move
   // ---------------------------------------------------
@@ -134,23 +162,40 @@ void movePiece(chess::Game &current_game) {
               S_promotion);
 
   // ---------------------------------------------------------------
-  // Check if this move we just did put the oponent's king in check
-  // Keep in mind that player turn has already changed
+  // Check if this move we just did ended the game or put the oponent's king
+  // in check. Keep in mind that player turn has already changed
   // ---------------------------------------------------------------
-  if (current_game.playerKingInCheck()) {
-    if (current_game.isCheckMate()) {
-      if (chess::Side::kWhite == current_game.getCurrentTurn()) {
-        appendToNextMessage("Checkmate! Black wins the game!\n");
-      } else {
-        appendToNextMessage("Checkmate! White wins the game!\n");
-      }
+  switch (current_game.status()) {
+  case chess::GameStatus::kCheckmate:
+    if (chess::Side::kWhite == current_game.getCurrentTurn()) {
+      appendToNextMessage("Checkmate! Black wins the game!\n");
     } else {
+      appendToNextMessage("Checkmate! White wins the game!\n");
+    }
+    break;
+
+  case chess::GameStatus::kStalemate:
+    appendToNextMessage("Stalemate! The game is a draw.\n");
+    break;
+
+  case chess::GameStatus::kThreefoldRepetition:
+    appendToNextMessage("The position repeated three times. It is a draw.\n");
+    break;
+
+  case chess::GameStatus::kFiftyMoveRule:
+    appendToNextMessage("Fifty moves without a capture or a pawn move. "
+                        "It is a draw.\n");
+    break;
+
+  case chess::GameStatus::kOngoing:
+    if (current_game.playerKingInCheck()) {
       if (chess::Side::kWhite == current_game.getCurrentTurn()) {
         appendToNextMessage("White king is in check!\n");
       } else {
         appendToNextMessage("Black king is in check!\n");
       }
     }
+    break;
   }
 
   return;
@@ -158,10 +203,22 @@ void movePiece(chess::Game &current_game) {
 
 } // namespace chess
 
-int main() {
+int main(int argc, char *argv[]) {
   chess::clearScreen();
   chess::printLogo();
 
+  // An opening book may be given on the command line, otherwise the hint
+  // command asks for one
+  std::optional<chess::OpeningBook> book;
+  if (argc > 1) {
+    try {
+      book.emplace(argv[1]);
+    } catch (const chess::GameException &err) {
+      chess::createNextMessage(std::string{err.what()} + "\n");
+    }
+  }
+  std::mt19937_64 random{std::random_device{}()};
+
   bool bRun = true;
   chess::Game current_game;
   while (bRun) {
@@ -235,6 +292,30 @@ int main() {
         chess::printBoard(current_game);
       } break;
 
+      case 'H':
+      case 'h': {
+        chess::showHint(current_game, book, random);
+        chess::printLogo();
+        chess::printSituation(current_game);
+        chess::printBoard(current_game);
+      } break;
+
+      case 'F':
+      case 'f': {
+        std::cout << "Type a FEN to set up, or nothing to show this one: ";
+        std::string fen;
+        getline(std::cin, fen);
+        if (fen.empty()) {
+          chess::createNextMessage(current_game.toFen() + "\n");
+        } else {
+          current_game = chess::Game::fromFen(fen);
+        }
+        chess::clearScreen();
+        chess::printLogo();
+        chess::printSituation(current_game);
+        chess::printBoard(current_game);
+      } break;
+
       default: {
         std::cout << "Option does not exist\n\n";
       } break;
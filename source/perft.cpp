@@ -0,0 +1,175 @@
+#include "game.hpp"
+#include "load_save.hpp"
+#include "perft.hpp"
+#include "thread_count.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+void printUsage() {
+  std::cerr
+      << "Usage: perft [options] <depth> [game.dat]\n"
+         "Counts the positions reached after <depth> moves from the initial "
+         "board,\nor from the end of the saved game.\n\n"
+         "  -f <fen>       start from this position instead\n"
+         "  -t <threads>   worker threads, 0 for one per hardware thread\n"
+         "  -s             split the replies to each root move across "
+         "threads\n"
+         "  -h <mb>        share a hash table of <mb> megabytes between "
+         "threads\n"
+         "  -b             report the throughput for 1, 2, 4... up to "
+         "<threads>\n";
+}
+
+struct Arguments {
+  int depth = 0;
+  std::filesystem::path file;
+  std::string fen;
+  chess::PerftOptions options;
+  std::size_t hash_mb = 0;
+  bool scaling = false;
+};
+
+/// @return False if the command line is not understood.
+bool parseArguments(const int argc, char *argv[], Arguments &arguments) {
+  std::vector<std::string> positional;
+  for (int i = 1; i < argc; i++) {
+    const std::string argument{argv[i]};
+    if (argument == "-s") {
+      arguments.options.splitReplies = true;
+    } else if (argument == "-b") {
+      arguments.scaling = true;
+    } else if (argument == "-t" && i + 1 < argc) {
+      arguments.options.threads = std::stoi(argv[++i]);
+    } else if (argument == "-f" && i + 1 < argc) {
+      arguments.fen = argv[++i];
+    } else if (argument == "-h" && i + 1 < argc) {
+      arguments.hash_mb = static_cast<std::size_t>(std::stoul(argv[++i]));
+    } else if (!argument.empty() && argument[0] == '-') {
+      return false;
+    } else {
+      positional.push_back(argument);
+    }
+  }
+  if (positional.empty() || positional.size() > 2) {
+    return false;
+  }
+  arguments.depth = std::stoi(positional[0]);
+  if (positional.size() == 2) {
+    if (!arguments.fen.empty()) {
+      return false;
+    }
+    arguments.file = positional[1];
+  }
+  return arguments.depth >= 1 && arguments.options.threads >= 0;
+}
+
+struct PerftRun {
+  std::vector<chess::PerftDivide> divide;
+  std::uint64_t nodes = 0;
+  double seconds = 0.0;
+};
+
+/// Counts with a hash table of its own, so runs do not feed each other.
+PerftRun runPerft(const chess::Game &game, const Arguments &arguments,
+                  chess::PerftOptions options) {
+  std::unique_ptr<chess::PerftCache> cache;
+  if (arguments.hash_mb > 0) {
+    cache = std::make_unique<chess::PerftCache>(arguments.hash_mb);
+    options.cache = cache.get();
+  }
+  PerftRun run;
+  const auto start = std::chrono::steady_clock::now();
+  run.divide = chess::perftDivide(game, arguments.depth, options);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  run.seconds = elapsed.count();
+  for (const chess::PerftDivide &entry : run.divide) {
+    run.nodes += entry.nodes;
+  }
+  return run;
+}
+
+std::uint64_t nodesPerSecond(const PerftRun &run) {
+  return run.seconds > 0.0 ? static_cast<std::uint64_t>(
+                                 static_cast<double>(run.nodes) / run.seconds)
+                           : 0;
+}
+
+void printScaling(const chess::Game &game, const Arguments &arguments) {
+  const int max_threads = chess::threadCount(arguments.options.threads);
+  std::cout << "\nThreads  Time (s)  Nodes per second  Speedup\n";
+  double single_thread_seconds = 0.0;
+  for (int threads = 1;; threads = std::min(threads * 2, max_threads)) {
+    chess::PerftOptions options = arguments.options;
+    options.threads = threads;
+    const PerftRun run = runPerft(game, arguments, options);
+    if (threads == 1) {
+      single_thread_seconds = run.seconds;
+    }
+    std::cout << threads << "  " << run.seconds << "  " << nodesPerSecond(run)
+              << "  "
+              << (run.seconds > 0.0 ? single_thread_seconds / run.seconds
+                                    : 1.0)
+              << '\n';
+    if (threads == max_threads) {
+      break;
+    }
+  }
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Arguments arguments;
+  bool understood = false;
+  try {
+    understood = parseArguments(argc, argv, arguments);
+  } catch (const std::exception &) {
+    understood = false;
+  }
+  if (!understood) {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  chess::Game game;
+  if (!arguments.file.empty()) {
+    // A game that can not be replayed must not fall back to a new one
+    chess::LoadedGame loaded = chess::readGame(arguments.file);
+    if (!loaded.error.empty()) {
+      std::cerr << "Error loading " << arguments.file.string() << ": "
+                << loaded.error << '\n';
+      return EXIT_FAILURE;
+    }
+    game = std::move(loaded.game);
+  } else if (!arguments.fen.empty()) {
+    try {
+      game = chess::Game::fromFen(arguments.fen);
+    } catch (const chess::GameException &err) {
+      std::cerr << err.what() << '\n';
+      return EXIT_FAILURE;
+    }
+  }
+
+  const PerftRun run = runPerft(game, arguments, arguments.options);
+  for (const auto &[move, nodes] : run.divide) {
+    std::cout << chess::toString(move) << ": " << nodes << '\n';
+  }
+  std::cout << "\nNodes: " << run.nodes << '\n'
+            << "Time: " << run.seconds << " s\n"
+            << "Nodes per second: " << nodesPerSecond(run) << '\n';
+
+  if (arguments.scaling) {
+    printScaling(game, arguments);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include "game.hpp"
+#include "game_archive.hpp"
+#include "pgn.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+
+namespace {
+void printUsage() {
+  std::cerr << "Usage: pgn_import [options] <games.pgn>\n"
+               "Reads every game of a PGN file and reports the games read "
+               "per second.\n\n"
+               "  -t <threads>   worker threads, 0 for one per hardware "
+               "thread\n"
+               "  -o <file" << chess::kArchiveExtension
+            << ">  write the games read into a game archive\n";
+}
+
+struct Arguments {
+  std::filesystem::path input;
+  std::filesystem::path archive;
+  chess::PgnOptions options;
+};
+
+/// @return False if the command line is not understood.
+bool parseArguments(const int argc, char *argv[], Arguments &arguments) {
+  for (int i = 1; i < argc; i++) {
+    const std::string argument{argv[i]};
+    if (argument == "-t" && i + 1 < argc) {
+      arguments.options.threads = std::stoi(argv[++i]);
+    } else if (argument == "-o" && i + 1 < argc) {
+      arguments.archive = argv[++i];
+    } else if (!argument.empty() && argument[0] == '-') {
+      return false;
+    } else if (arguments.input.empty()) {
+      arguments.input = argument;
+    } else {
+      return false;
+    }
+  }
+  return !arguments.input.empty() && arguments.options.threads >= 0;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Arguments arguments;
+  bool understood = false;
+  try {
+    understood = parseArguments(argc, argv, arguments);
+  } catch (const std::exception &) {
+    understood = false;
+  }
+  if (!understood) {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  try {
+    std::optional<chess::ArchiveWriter> writer;
+    if (!arguments.archive.empty()) {
+      writer.emplace(arguments.archive);
+    }
+    std::size_t games = 0;
+    std::size_t moves = 0;
+    const chess::PgnStats stats = chess::readPgn(
+        arguments.input,
+        [&](chess::PgnGame &&game) {
+          games++;
+          moves += game.moves.size();
+          if (!game.error.empty()) {
+            std::cout << "Game " << games << ": " << game.error << '\n';
+          } else if (writer) {
+            writer->add(game.fen, game.moves);
+          }
+        },
+        arguments.options);
+
+    std::cout << "Games: " << stats.games << '\n'
+              << "Failed: " << stats.failed << '\n'
+              << "Moves: " << moves << '\n'
+              << "Time: " << stats.seconds << " s\n"
+              << "Games per second: "
+              << static_cast<std::uint64_t>(stats.gamesPerSecond()) << '\n';
+
+    if (writer) {
+      writer->finish();
+      std::cout << "Archive: " << arguments.archive.string() << '\n';
+    }
+  } catch (const chess::GameException &err) {
+    std::cerr << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
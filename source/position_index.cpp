@@ -0,0 +1,132 @@
+#include "game.hpp"
+#include "game_archive.hpp"
+#include "position_index.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+void printUsage() {
+  std::cerr << "Usage: position_index [options] <games"
+            << chess::kArchiveExtension << "> <index"
+            << chess::kPositionIndexExtension
+            << ">\n"
+               "       position_index -q <fen> [-n <games>] <index"
+            << chess::kPositionIndexExtension
+            << ">\n"
+               "Indexes the position after each move of every archived "
+               "game, or lists the\ngames that reached a position.\n\n"
+               "  -t <threads>   worker threads, 0 for one per hardware "
+               "thread\n"
+               "  -p <plies>     only index the first <plies> moves of "
+               "each game\n"
+               "  -m <mb>        megabytes of positions to sort in memory, "
+               "256 by default\n"
+               "  -T <dir>       directory for the sorted runs\n"
+               "  -q <fen>       look up this position\n"
+               "  -n <games>     list at most <games> games, 10 by default\n";
+}
+
+struct Arguments {
+  std::vector<std::filesystem::path> files;
+  chess::PositionIndexOptions options;
+  std::string fen;
+  std::size_t limit = 10;
+};
+
+/// @return False if the command line is not understood.
+bool parseArguments(const int argc, char *argv[], Arguments &arguments) {
+  for (int i = 1; i < argc; i++) {
+    const std::string argument{argv[i]};
+    if (argument == "-t" && i + 1 < argc) {
+      arguments.options.sort.threads = std::stoi(argv[++i]);
+    } else if (argument == "-p" && i + 1 < argc) {
+      arguments.options.maxPly =
+          static_cast<std::uint32_t>(std::stoul(argv[++i]));
+    } else if (argument == "-m" && i + 1 < argc) {
+      arguments.options.sort.memory = std::stoul(argv[++i]) << 20;
+    } else if (argument == "-T" && i + 1 < argc) {
+      arguments.options.sort.tempDirectory = argv[++i];
+    } else if (argument == "-q" && i + 1 < argc) {
+      arguments.fen = argv[++i];
+    } else if (argument == "-n" && i + 1 < argc) {
+      arguments.limit = std::stoul(argv[++i]);
+    } else if (!argument.empty() && argument[0] == '-') {
+      return false;
+    } else {
+      arguments.files.emplace_back(argument);
+    }
+  }
+  const std::size_t files = arguments.fen.empty() ? 2 : 1;
+  return arguments.files.size() == files &&
+         arguments.options.sort.threads >= 0 &&
+         arguments.options.sort.memory > 0;
+}
+
+void query(const Arguments &arguments) {
+  const chess::GameState state = chess::GameState::fromFen(arguments.fen);
+  const auto start = std::chrono::steady_clock::now();
+  const chess::PositionIndex index{arguments.files[0]};
+  const std::size_t count = index.count(state.hash());
+  const std::vector<chess::PositionPosting> postings =
+      index.find(state, arguments.limit);
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  for (const chess::PositionPosting &posting : postings) {
+    std::cout << "Game " << posting.game + 1 << ", ply " << posting.ply
+              << '\n';
+  }
+  if (count > postings.size()) {
+    std::cout << "...\n";
+  }
+  std::cout << "Reached: " << count << " times\n"
+            << "Games indexed: " << index.gameCount() << '\n'
+            << "Time: " << elapsed.count() << " ms\n";
+}
+
+void build(const Arguments &arguments) {
+  const chess::GameArchive archive{arguments.files[0]};
+  const chess::PositionIndexStats stats = chess::buildPositionIndex(
+      archive, arguments.files[1], arguments.options);
+  std::cout << "Games: " << stats.games << '\n'
+            << "Failed: " << stats.failed << '\n'
+            << "Positions: " << stats.postings << '\n'
+            << "Sorted runs: " << stats.runs << '\n'
+            << "Time: " << stats.seconds << " s\n";
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Arguments arguments;
+  bool understood = false;
+  try {
+    understood = parseArguments(argc, argv, arguments);
+  } catch (const std::exception &) {
+    understood = false;
+  }
+  if (!understood) {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  try {
+    if (arguments.fen.empty()) {
+      build(arguments);
+    } else {
+      query(arguments);
+    }
+  } catch (const chess::GameException &err) {
+    std::cerr << err.what() << '\n';
+    return EXIT_FAILURE;
+  } catch (const std::filesystem::filesystem_error &err) {
+    std::cerr << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 namespace chess {
+class AttackMap;
 class Board;
 struct IntendedMove;
 struct Position;
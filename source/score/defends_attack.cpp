@@ -1,11 +1,8 @@
 #include "defends_attack.hpp"
 
+#include <core/attack_map.hpp>
 #include <core/board.hpp>
-#include <core/board_view.hpp>
-#include <core/logic.hpp>
 
-#include <functional>
-#include <ranges>
 #include <unordered_map>
 
 namespace chess::score {
@@ -16,38 +13,35 @@ std::unordered_map<chess::Piece, double> kPieceValues = {
     {Piece::kRook, 5.0}, {Piece::kQueen, 9.0},  {Piece::kKing, 100.0},
 };
 
-class HasPieceWithSide {
-public:
-  HasPieceWithSide(const chess::Side side) : mSide(side) {}
-
-  [[nodiscard]] bool
-  operator()(const chess::Board::Iterator::value_type &stateAndPosition) const {
-    return stateAndPosition.first.has_value()
-               ? stateAndPosition.first->mSide == mSide
-               : false;
-  }
-
-private:
-  chess::Side mSide;
-};
 } // namespace
 
 double DefendsAttack::operator()(const chess::Board &board,
                                  const chess::IntendedMove &move) const {
+  return (*this)(board, chess::AttackMap{board}, move);
+}
+
+double DefendsAttack::operator()(const chess::Board &board,
+                                 const chess::AttackMap &attacks,
+                                 const chess::IntendedMove &move) const {
   const chess::Side defendingSide = move.piece.mSide;
+  const chess::Side attackingSide = chess::opponentSide(defendingSide);
+  const chess::Bitboard attackedBefore =
+      board.pieces(defendingSide) & attacks.attacked(attackingSide);
+  if (attackedBefore == chess::kEmptyBitboard) {
+    // Nothing to defend
+    return 0.0;
+  }
+
+  chess::Board boardAfter = board;
+  boardAfter.setSquare(move.from, std::nullopt);
+  boardAfter.setSquare(move.to, move.piece);
+  const chess::AttackMap attacksAfter{boardAfter};
+
   double defendedValue = 0.0;
-  namespace rv = std::ranges::views;
-  for (const auto [state, position] :
-       chess::BoardView{board} | rv::filter(HasPieceWithSide{defendingSide})) {
-
-    const chess::UnderAttack underAttackBefore =
-        chess::underAttack(position, defendingSide, board);
-    if (underAttackBefore.bUnderAttack) {
-      const chess::UnderAttack underAttackAfter =
-          chess::underAttack(position, defendingSide, board, move);
-      defendedValue +=
-          underAttackAfter.bUnderAttack ? 0.0 : kPieceValues.at(state->mPiece);
-    }
+  for (const int square : chess::BitboardSquares{
+           attackedBefore & ~attacksAfter.attacked(attackingSide)}) {
+    defendedValue +=
+        kPieceValues.at(board(chess::squareToPosition(square))->mPiece);
   }
   return defendedValue;
 }
@@ -59,21 +53,6 @@ double DefendsAttack::operator()(const chess::Board &board,
 
 #include <catch2/catch_test_macros.hpp>
 
-TEST_CASE("HasPieceWithSide range loop") {
-  namespace cs = chess::score;
-  namespace rv = std::ranges::views;
-
-  const auto board = chess::Board{};
-  int count = 0;
-  for (const auto [state, position] :
-       chess::BoardView{board} |
-           rv::filter(cs::HasPieceWithSide{chess::Side::kWhite})) {
-    ++count;
-  }
-  constexpr int numPieces = 16;
-  CHECK(count == numPieces);
-}
-
 TEST_CASE("DefendsAttack") {
   using namespace chess::pieces;
 
@@ -100,6 +79,10 @@ TEST_CASE("DefendsAttack") {
       .from = {2, 3},
       .to = {0, 3}};
   CHECK(scorer(board, noDefense) == 0.0);
+
+  const auto attacks = chess::AttackMap{board};
+  CHECK(scorer(board, attacks, queenDefendsKing) == 100.0);
+  CHECK(scorer(board, attacks, noDefense) == 0.0);
 }
 
 #endif
@@ -7,5 +7,11 @@ class DefendsAttack {
 public:
   [[nodiscard]] double operator()(const chess::Board &board,
                                   const chess::IntendedMove &move) const;
+
+  /// Scores @a move with @a attacks, the attack map of @a board, so that a
+  /// list of moves shares one map for the position before the move.
+  [[nodiscard]] double operator()(const chess::Board &board,
+                                  const chess::AttackMap &attacks,
+                                  const chess::IntendedMove &move) const;
 };
 } // namespace chess::score
@@ -1,5 +1,6 @@
 #include "escapes_attack.hpp"
 
+#include <core/attack_map.hpp>
 #include <core/board.hpp>
 #include <core/logic.hpp>
 
@@ -19,6 +20,15 @@ double EscapesAttack::operator()(const chess::Board &board,
                              !underAttackAtNewLocation.bUnderAttack;
   return escapesAttack ? 1.0 : 0.0;
 }
+
+double EscapesAttack::operator()(const chess::Board &,
+                                 const chess::AttackMap &attacks,
+                                 const chess::IntendedMove &move) const {
+  const chess::Side attackingSide = chess::opponentSide(move.piece.mSide);
+  const bool escapesAttack = attacks.isAttacked(move.from, attackingSide) &&
+                             !attacks.isAttacked(move.to, attackingSide);
+  return escapesAttack ? 1.0 : 0.0;
+}
 } // namespace chess::score
 
 #if defined(UNIT_TEST)
@@ -64,6 +74,10 @@ TEST_CASE("Escapes attack") {
                             .from = {3, 2},
                             .to = {5, 1}};
     CHECK(scorer(board, knightUnsafeMove) == 0.0);
+
+    const auto attacks = chess::AttackMap{board};
+    CHECK(scorer(board, attacks, knightSafeMove) == 1.0);
+    CHECK(scorer(board, attacks, knightUnsafeMove) == 0.0);
   }
 }
 
@@ -7,5 +7,10 @@ class EscapesAttack {
 public:
   [[nodiscard]] double operator()(const chess::Board &board,
                                   const chess::IntendedMove &move) const;
+
+  /// Same as above, reading the attacked squares from @a attacks.
+  [[nodiscard]] double operator()(const chess::Board &board,
+                                  const chess::AttackMap &attacks,
+                                  const chess::IntendedMove &move) const;
 };
 } // namespace chess::score
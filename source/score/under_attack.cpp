@@ -1,5 +1,6 @@
 #include "under_attack.hpp"
 
+#include <core/attack_map.hpp>
 #include <core/board.hpp>
 #include <core/logic.hpp>
 
@@ -12,6 +13,13 @@ double UnderAttack::operator()(const chess::Board &board,
   return -result.iNumAttackers;
 }
 
+double UnderAttack::operator()(const chess::Board &,
+                               const chess::AttackMap &attacks,
+                               const chess::IntendedMove &move) const {
+  return -attacks.attackerCount(move.to,
+                                chess::opponentSide(move.piece.mSide));
+}
+
 } // namespace chess::score
 
 #if defined(UNIT_TEST)
@@ -33,6 +41,14 @@ TEST_CASE("Initial board") {
                                     chess::Side::kWhite)) == 0.0);
   CHECK(scorer(board, cst::testMove(chess::Position{3, 3},
                                     chess::Side::kBlack)) == 0.0);
+
+  const auto attacks = chess::AttackMap{board};
+  CHECK(scorer(board, attacks,
+               cst::testMove(chess::Position{2, 0}, chess::Side::kBlack)) ==
+        -2.0);
+  CHECK(scorer(board, attacks,
+               cst::testMove(chess::Position{3, 3}, chess::Side::kWhite)) ==
+        0.0);
 }
 
 #endif
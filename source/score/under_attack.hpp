@@ -7,5 +7,10 @@ class UnderAttack {
 public:
   [[nodiscard]] double operator()(const chess::Board &board,
                                   const chess::IntendedMove &move) const;
+
+  /// Same as above, counting the attackers in @a attacks.
+  [[nodiscard]] double operator()(const chess::Board &board,
+                                  const chess::AttackMap &attacks,
+                                  const chess::IntendedMove &move) const;
 };
 } // namespace chess::score
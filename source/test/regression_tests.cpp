@@ -8,7 +8,7 @@ TEST_CASE("black_promote", "[regression]") {
   // clang-format off
   constexpr chess::Board::BoardArray expected{
     //A  B  C  D  E  F  G  H
-      E, E, E, Q, r, E, E, E,  // 1
+      E, E, E, q, r, E, E, E,  // 1
       E, E, E, E, E, n, E, K,  // 2
       E, P, E, E, E, p, P, P,  // 3
       E, E, E, E, E, E, E, E,  // 4
@@ -20,7 +20,7 @@ TEST_CASE("black_promote", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/black_promote.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
 }
 
 TEST_CASE("bug", "[regression]") {
@@ -39,7 +39,7 @@ TEST_CASE("bug", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/bug.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
 }
 
 TEST_CASE("burro", "[regression]") {
@@ -58,7 +58,7 @@ TEST_CASE("burro", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/burro.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
 }
 
 TEST_CASE("castling_both", "[regression]") {
@@ -77,7 +77,7 @@ TEST_CASE("castling_both", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/castling_both.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
 }
 
 TEST_CASE("check", "[regression]") {
@@ -96,7 +96,7 @@ TEST_CASE("check", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/check.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
 }
 
 TEST_CASE("checkmate", "[regression]") {
@@ -115,7 +115,29 @@ TEST_CASE("checkmate", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/checkmate.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
+}
+
+TEST_CASE("fen_black_to_move", "[regression]") {
+  using namespace chess::pieces;
+  // clang-format off
+  constexpr chess::Board::BoardArray expected{
+    //A  B  C  D  E  F  G  H
+      R, E, E, E, E, R, K, E,  // 1
+      P, P, P, B, B, P, p, P,  // 2
+      E, E, N, E, E, Q, E, E,  // 3
+      E, p, E, E, P, E, E, E,  // 4
+      E, E, E, P, N, E, E, E,  // 5
+      b, n, E, E, p, n, p, E,  // 6
+      p, E, p, p, q, p, b, E,  // 7
+      E, E, k, r, E, E, E, r}; // 8
+  // clang-format on
+
+  const chess::Game game = chess::loadGame("dat/fen_black_to_move.dat");
+
+  CHECK(game.board() == chess::Board{expected});
+  CHECK(game.toFen() ==
+        "2kr3r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q2/PPPBBPpP/R4RK1 w - - 0 3");
 }
 
 TEST_CASE("impossible", "[regression]") {
@@ -134,7 +156,13 @@ TEST_CASE("impossible", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/impossible.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
+
+  // The moves before the illegal one are kept when reading quietly
+  const chess::LoadedGame loaded = chess::readGame("dat/impossible.dat");
+  CHECK(loaded.error ==
+        "line 4: illegal move D1-D5 (Piece can not move to that square)");
+  CHECK(loaded.game.rounds.size() == 2);
 }
 
 TEST_CASE("kasparov_2", "[regression]") {
@@ -153,7 +181,7 @@ TEST_CASE("kasparov_2", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/kasparov_2.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
 }
 
 TEST_CASE("KasparovVSdeepblue_game_1", "[regression]") {
@@ -172,7 +200,7 @@ TEST_CASE("KasparovVSdeepblue_game_1", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/KasparovVSdeepblue_game_1.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
 }
 
 TEST_CASE("king_side", "[regression]") {
@@ -191,7 +219,7 @@ TEST_CASE("king_side", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/king_side.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
 }
 
 TEST_CASE("open_castling", "[regression]") {
@@ -210,7 +238,28 @@ TEST_CASE("open_castling", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/open_castling.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
+}
+
+TEST_CASE("opera", "[regression]") {
+  using namespace chess::pieces;
+  // clang-format off
+  constexpr chess::Board::BoardArray expected{
+    //A  B  C  D  E  F  G  H
+      E, E, K, E, E, E, E, E,  // 1
+      P, P, P, E, E, P, P, P,  // 2
+      E, E, E, E, E, E, E, E,  // 3
+      E, E, E, E, P, E, E, E,  // 4
+      E, E, E, E, p, E, B, E,  // 5
+      E, E, E, E, q, E, E, E,  // 6
+      p, E, E, E, E, p, p, p,  // 7
+      E, n, E, R, k, b, E, r}; // 8
+  // clang-format on
+
+  const chess::Game game = chess::loadGame("dat/opera.pgn");
+
+  CHECK(game.board() == chess::Board{expected});
+  CHECK(game.isCheckMate());
 }
 
 TEST_CASE("passant_check", "[regression]") {
@@ -229,7 +278,7 @@ TEST_CASE("passant_check", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/passant_check.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
 }
 
 TEST_CASE("passant_done", "[regression]") {
@@ -248,7 +297,7 @@ TEST_CASE("passant_done", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/passant_done.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
 }
 
 TEST_CASE("passant", "[regression]") {
@@ -267,7 +316,7 @@ TEST_CASE("passant", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/passant.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
 }
 
 TEST_CASE("queen_side", "[regression]") {
@@ -286,7 +335,7 @@ TEST_CASE("queen_side", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/queen_side.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
 }
 
 TEST_CASE("white_promote", "[regression]") {
@@ -305,5 +354,5 @@ TEST_CASE("white_promote", "[regression]") {
 
   const chess::Game game = chess::loadGame("dat/white_promote.dat");
 
-  CHECK(game.board().boardState() == expected);
+  CHECK(game.board() == chess::Board{expected});
 }